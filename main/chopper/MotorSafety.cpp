@@ -6,8 +6,10 @@
 
 #include <inttypes.h>
 #include <algorithm>
+#include <chrono>
 #include <utility>
 #include <thread>
+#include <array>
 #include <atomic>
 #include <vector>
 #include <Bluepad32.h>
@@ -33,6 +35,7 @@ class Thread {
   void Main();
   void Start(std::string name);
   void Stop();
+  void Reschedule();
   // void Join();
   
   esp_pthread_cfg_t m_cfg = esp_pthread_get_default_config();
@@ -44,17 +47,29 @@ class Thread {
   std::atomic_bool m_joinAtExit{true};
   std::thread::id m_threadId;
   wpi::condition_variable m_cond;
+  // set under m_mutex when a stop time may have moved earlier
+  bool m_reschedule = false;
 };
 
 void Thread::Main() {
   Console.printf("Thread::Main [%s]\n", m_cfg.thread_name);
-  int safetyCounter = 0;
+  bool rebuild = true;
   while (m_active) {
-    if (++safetyCounter >= 4) {
-      MotorSafety::CheckMotors();
-      safetyCounter = 0;
+    uint64_t next = MotorSafety::CheckDeadlines(rebuild);
+
+    // sleep until the earliest stop time, or until one moves earlier
+    std::unique_lock lock(m_mutex);
+    auto woken = [this] { return m_reschedule || !m_active; };
+    if (next == UINT64_MAX) {
+      m_cond.wait(lock, woken);
+    } else {
+      uint64_t now = Timer::GetFPGATimestamp();
+      if (next > now) {
+        m_cond.wait_for(lock, std::chrono::milliseconds(next - now), woken);
+      }
     }
-    vTaskDelay(100 / portTICK_PERIOD_MS);
+    rebuild = m_reschedule;
+    m_reschedule = false;
   }
   // wpi::Event event{false, false};
   // HAL_ProvideNewDataEventHandle(event.GetHandle());
@@ -92,10 +107,21 @@ void Thread::Start(std::string name) {
 }
 
 void Thread::Stop() {
-  m_active = false;
+  {
+    std::scoped_lock lock(m_mutex);
+    m_active = false;
+  }
   m_cond.notify_all();
 }
 
+void Thread::Reschedule() {
+  {
+    std::scoped_lock lock(m_mutex);
+    m_reschedule = true;
+  }
+  m_cond.notify_one();
+}
+
 // void Thread::Join() {
 //   std::unique_lock lock(m_mutex);
 //   if (auto thr = m_thread.lock()) {
@@ -112,13 +138,40 @@ void Thread::Stop() {
 static std::atomic_bool gShutdown{false};
 
 namespace {
+// Stop times are 32 bit milliseconds so they fit a lock-free atomic on the
+// ESP32, and are compared by their distance to survive the wrap at ~49 days
+uint32_t Now() {
+  return static_cast<uint32_t>(Timer::GetFPGATimestamp());
+}
+
+static_assert(std::atomic<uint32_t>::is_always_lock_free);
+
+bool IsBefore(uint32_t time, uint32_t other) {
+  return static_cast<int32_t>(time - other) < 0;
+}
+
+struct Deadline {
+  uint32_t stopTime;
+  uint8_t slot;
+
+  // orders the heap with the earliest stop time on top
+  bool operator<(const Deadline& rhs) const { return IsBefore(rhs.stopTime, stopTime); }
+};
+
 struct MotorSafetyManager {
+  static constexpr uint8_t kMaxInstances = 8;
+
   ~MotorSafetyManager() { gShutdown = true; }
 
   Thread thread;
-  std::vector<MotorSafety*> instanceList;
-  wpi::mutex listMutex;
-  bool threadStarted = false;
+  // registered instances, a slot is claimed and released with a single
+  // compare-and-swap so Feed() and the watchdog never wait on each other
+  std::array<std::atomic<MotorSafety*>, kMaxInstances> instances{};
+  // true while the watchdog holds pointers out of instances
+  std::atomic_bool checking{false};
+  // min-heap of stop times, only touched by the watchdog thread
+  std::vector<Deadline> deadlines;
+  std::atomic_bool threadStarted{false};
 };
 }  // namespace
 
@@ -129,76 +182,165 @@ static MotorSafetyManager& GetManager() {
 
 MotorSafety::MotorSafety() {
   auto& manager = GetManager();
-  std::scoped_lock lock(manager.listMutex);
-  manager.instanceList.push_back(this);
-  if (!manager.threadStarted) {
-    manager.threadStarted = true;
+  bool isRegistered = false;
+  for (auto& slot : manager.instances) {
+    MotorSafety* empty = nullptr;
+    if (slot.compare_exchange_strong(empty, this)) {
+      isRegistered = true;
+      break;
+    }
+  }
+  if (!isRegistered) {
+    Console.printf("MotorSafety: more than %u instances, not watched\n", MotorSafetyManager::kMaxInstances);
+  }
+  if (!manager.threadStarted.exchange(true)) {
+    manager.deadlines.reserve(MotorSafetyManager::kMaxInstances);
     manager.thread.Start("Thread n");
     // manager.thread.m_stdThread = std::thread(&Thread::Main, &manager.thread);
   }
+  manager.thread.Reschedule();
 }
 
 MotorSafety::~MotorSafety() {
   auto& manager = GetManager();
-  std::scoped_lock lock(manager.listMutex);
   manager.thread.Stop();
-  manager.instanceList.erase(std::remove(manager.instanceList.begin(), manager.instanceList.end(), this), manager.instanceList.end());
+  for (auto& slot : manager.instances) {
+    MotorSafety* self = this;
+    slot.compare_exchange_strong(self, nullptr);
+  }
+  // the watchdog may still be checking this instance from before it was removed
+  while (manager.checking) {
+    std::this_thread::yield();
+  }
 }
 
 MotorSafety::MotorSafety(MotorSafety&& rhs)
-    : m_expiration(std::move(rhs.m_expiration)),
-      m_enabled(std::move(rhs.m_enabled)),
-      m_stopTime(std::move(rhs.m_stopTime)) {}
+    : m_expiration(rhs.m_expiration.load()),
+      m_enabled(rhs.m_enabled.load()),
+      m_stopTime(rhs.m_stopTime.load()),
+      m_state(rhs.m_state.load()),
+      m_rampTime(rhs.m_rampTime.load()),
+      m_rampStart(rhs.m_rampStart) {
+  std::scoped_lock lock(rhs.m_rampMutex);
+  m_rampFlush = std::move(rhs.m_rampFlush);
+}
 
 MotorSafety& MotorSafety::operator=(MotorSafety&& rhs) {
-  std::scoped_lock lock(m_thisMutex, rhs.m_thisMutex);
-
-  m_expiration = std::move(rhs.m_expiration);
-  m_enabled = std::move(rhs.m_enabled);
-  m_stopTime = std::move(rhs.m_stopTime);
+  m_expiration = rhs.m_expiration.load();
+  m_enabled = rhs.m_enabled.load();
+  m_stopTime = rhs.m_stopTime.load();
+  m_state = rhs.m_state.load();
+  m_rampTime = rhs.m_rampTime.load();
+  m_rampStart = rhs.m_rampStart;
+  std::scoped_lock lock(m_rampMutex, rhs.m_rampMutex);
+  m_rampFlush = std::move(rhs.m_rampFlush);
 
   return *this;
 }
 
 void MotorSafety::Feed() {
-  std::scoped_lock lock(m_thisMutex);
-  m_stopTime = Timer::GetFPGATimestamp() + m_expiration;
+  uint32_t now = Now();
+  uint32_t stopTime = now + m_expiration.load(std::memory_order_relaxed);
+  uint32_t previous = m_stopTime.load(std::memory_order_relaxed);
+  m_stopTime.store(stopTime, std::memory_order_relaxed);
+  if (m_state.exchange(kRunning, std::memory_order_relaxed) != kRunning) {
+    m_stoppedTime.fetch_add(now - m_lastExpiry.load(std::memory_order_relaxed), std::memory_order_relaxed);
+  }
+  uint32_t lastFeed = m_lastFeed.exchange(now, std::memory_order_relaxed);
+  if (m_hasFed.exchange(true, std::memory_order_relaxed)) {
+    RecordFeedGap(now - lastFeed);
+  }
+  // a later stop time is picked up when the old one comes up in the heap,
+  // only a shortened expiration has to wake the watchdog
+  if (IsBefore(stopTime, previous) && m_enabled.load(std::memory_order_relaxed)) {
+    Reschedule();
+  }
 }
 
 void MotorSafety::SetExpiration(uint64_t expirationTime) {
-  std::scoped_lock lock(m_thisMutex);
-  m_expiration = expirationTime;
+  // a shorter expiration takes effect on the next Feed(), which wakes the
+  // watchdog if it moves the stop time earlier
+  m_expiration.store(static_cast<uint32_t>(std::min<uint64_t>(expirationTime, INT32_MAX)), std::memory_order_relaxed);
 }
 
 uint64_t MotorSafety::GetExpiration() const {
-  std::scoped_lock lock(m_thisMutex);
-  return m_expiration;
+  return m_expiration.load(std::memory_order_relaxed);
 }
 
 bool MotorSafety::IsAlive() const {
-  std::scoped_lock lock(m_thisMutex);
-  return !m_enabled || m_stopTime > Timer::GetFPGATimestamp();
+  return !m_enabled.load(std::memory_order_relaxed) ||
+         IsBefore(Now(), m_stopTime.load(std::memory_order_relaxed));
 }
 
 void MotorSafety::SetSafetyEnabled(bool enabled) {
-  std::scoped_lock lock(m_thisMutex);
-  m_enabled = enabled;
+  bool wasEnabled = m_enabled.exchange(enabled, std::memory_order_relaxed);
+  if (enabled && !wasEnabled) {
+    Reschedule();
+  }
 }
 
 bool MotorSafety::IsSafetyEnabled() const {
-  std::scoped_lock lock(m_thisMutex);
-  return m_enabled;
+  return m_enabled.load(std::memory_order_relaxed);
 }
 
-void MotorSafety::Check() {
-  bool enabled;
-  uint64_t stopTime;
+void MotorSafety::SetStopRamp(uint64_t rampTime, std::function<void()> flush) {
+  std::scoped_lock lock(m_rampMutex);
+  m_rampFlush = std::move(flush);
+  m_rampTime.store(static_cast<uint32_t>(std::min<uint64_t>(rampTime, INT32_MAX)), std::memory_order_relaxed);
+}
 
-  {
-    std::scoped_lock lock(m_thisMutex);
-    enabled = m_enabled;
-    stopTime = m_stopTime;
+bool MotorSafety::IsStopped() const {
+  return m_state.load(std::memory_order_relaxed) != kRunning;
+}
+
+MotorSafety::Stats MotorSafety::GetStats() const {
+  Stats stats;
+  uint32_t now = Now();
+  stats.expirations = m_expirations.load(std::memory_order_relaxed);
+  stats.maxFeedGap = m_maxFeedGap.load(std::memory_order_relaxed);
+  for (size_t i = 0; i < stats.feedGaps.size(); ++i) {
+    stats.feedGaps[i] = m_feedGaps[i].load(std::memory_order_relaxed);
+  }
+  uint32_t lastExpiry = m_lastExpiry.load(std::memory_order_relaxed);
+  stats.stoppedTime = m_stoppedTime.load(std::memory_order_relaxed);
+  if (IsStopped()) {
+    // the stop still going on
+    stats.stoppedTime += now - lastExpiry;
   }
+  stats.lastExpiry = stats.expirations == 0 ? 0 : Timer::GetFPGATimestamp() - (now - lastExpiry);
+  return stats;
+}
+
+void MotorSafety::ResetStats() {
+  m_expirations.store(0, std::memory_order_relaxed);
+  m_maxFeedGap.store(0, std::memory_order_relaxed);
+  for (auto& bucket : m_feedGaps) {
+    bucket.store(0, std::memory_order_relaxed);
+  }
+  m_stoppedTime.store(0, std::memory_order_relaxed);
+  if (IsStopped()) {
+    // count the stop still going on from the reset, not from its expiry
+    m_lastExpiry.store(Now(), std::memory_order_relaxed);
+  }
+}
+
+void MotorSafety::RecordFeedGap(uint32_t gap) {
+  size_t bucket = std::upper_bound(kFeedGapBounds.begin(), kFeedGapBounds.end(), gap) - kFeedGapBounds.begin();
+  m_feedGaps[bucket].fetch_add(1, std::memory_order_relaxed);
+  uint32_t maxGap = m_maxFeedGap.load(std::memory_order_relaxed);
+  while (gap > maxGap && !m_maxFeedGap.compare_exchange_weak(maxGap, gap, std::memory_order_relaxed)) {
+  }
+}
+
+void MotorSafety::RampMotor(float scale) {
+  if (scale <= 0.0f) {
+    StopMotor();
+  }
+}
+
+void MotorSafety::Check() {
+  bool enabled = m_enabled.load(std::memory_order_relaxed);
+  uint32_t stopTime = m_stopTime.load(std::memory_order_relaxed);
 
   if (!enabled) {
     return;
@@ -207,28 +349,140 @@ void MotorSafety::Check() {
   //   return;
   // }
 
-  if (stopTime < Timer::GetFPGATimestamp()) {
-    // FRC_ReportError(err::Timeout,
-    //                 "{}... Output not updated often enough. See "
-    //                 "https://docs.wpilib.org/motorsafety for more information.",
-    //                 GetDescription());
-    // Console.printf("MotorSafety::Check [%s] -> %llu\n", stopTime, GetDescription());
-    StopMotor();
-    // try {
-    //   StopMotor();
-    // } catch (frc::RuntimeError& e) {
-    //   e.Report();
-    // } catch (std::exception& e) {
-    //   FRC_ReportError(err::Error, "{} StopMotor threw unexpected exception: {}",
-    //                   GetDescription(), e.what());
-    // }
+  uint32_t now = Now();
+  if (IsBefore(now, stopTime)) {
+    return;
+  }
+
+  // FRC_ReportError(err::Timeout,
+  //                 "{}... Output not updated often enough. See "
+  //                 "https://docs.wpilib.org/motorsafety for more information.",
+  //                 GetDescription());
+  // Console.printf("MotorSafety::Check [%s] -> %llu\n", stopTime, GetDescription());
+  uint8_t state = kRunning;
+  if (m_state.compare_exchange_strong(state, kRamping, std::memory_order_relaxed)) {
+    // just expired, a Feed() since the load above would have failed the exchange
+    m_rampStart = now;
+    state = kRamping;
+    m_lastExpiry.store(now, std::memory_order_relaxed);
+    m_expirations.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  uint32_t rampTime = m_rampTime.load(std::memory_order_relaxed);
+  uint32_t elapsed = now - m_rampStart;
+  if (state == kRamping && elapsed < rampTime) {
+    RampMotor(1.0f - static_cast<float>(elapsed) / rampTime);
+  } else {
+    // the end of the ramp, then resent each expiration while latched stopped
+    RampMotor(0.0f);
+    uint8_t ramping = kRamping;
+    m_state.compare_exchange_strong(ramping, kStopped, std::memory_order_relaxed);
+  }
+  if (m_state.load(std::memory_order_relaxed) == kRunning) {
+    // fresh input landed during the step, put its command back
+    RampMotor(1.0f);
+  }
+  std::scoped_lock lock(m_rampMutex);
+  if (m_rampFlush) {
+    m_rampFlush();
   }
 }
 
 void MotorSafety::CheckMotors() {
   auto& manager = GetManager();
-  std::scoped_lock lock(manager.listMutex);
-  for (auto elem : manager.instanceList) {
+  manager.checking = true;
+  for (auto& slot : manager.instances) {
+    if (MotorSafety* elem = slot.load()) {
+      elem->Check();
+    }
+  }
+  manager.checking = false;
+}
+
+uint64_t MotorSafety::CheckDeadlines(bool rebuild) {
+  auto& manager = GetManager();
+  auto& deadlines = manager.deadlines;
+  manager.checking = true;
+
+  if (rebuild) {
+    deadlines.clear();
+    for (uint8_t i = 0; i < MotorSafetyManager::kMaxInstances; ++i) {
+      MotorSafety* elem = manager.instances[i].load();
+      if (elem != nullptr && elem->m_enabled.load(std::memory_order_relaxed)) {
+        deadlines.push_back({elem->m_stopTime.load(std::memory_order_relaxed), i});
+      }
+    }
+    std::make_heap(deadlines.begin(), deadlines.end());
+  }
+
+  uint32_t now = Now();
+  while (!deadlines.empty() && !IsBefore(now, deadlines.front().stopTime)) {
+    std::pop_heap(deadlines.begin(), deadlines.end());
+    uint8_t slot = deadlines.back().slot;
+    deadlines.pop_back();
+
+    MotorSafety* elem = manager.instances[slot].load();
+    if (elem == nullptr) {
+      // removed since it was queued
+      continue;
+    }
+
     elem->Check();
+
+    if (!elem->m_enabled.load(std::memory_order_relaxed)) {
+      // back in the heap when it is enabled again
+      continue;
+    }
+    uint32_t stopTime = elem->m_stopTime.load(std::memory_order_relaxed);
+    if (!IsBefore(now, stopTime)) {
+      if (elem->m_state.load(std::memory_order_relaxed) == kRamping) {
+        stopTime = now + kRampStepMs;
+      } else {
+        // latched stopped, stop it again after another expiration
+        stopTime = now + std::max<uint32_t>(elem->m_expiration.load(std::memory_order_relaxed), 1);
+      }
+    }
+    deadlines.push_back({stopTime, slot});
+    std::push_heap(deadlines.begin(), deadlines.end());
+  }
+
+  manager.checking = false;
+  if (deadlines.empty()) {
+    return UINT64_MAX;
+  }
+  return Timer::GetFPGATimestamp() + static_cast<int32_t>(deadlines.front().stopTime - Now());
+}
+
+void MotorSafety::PrintAllStats() {
+  auto& manager = GetManager();
+  for (auto& slot : manager.instances) {
+    MotorSafety* elem = slot.load();
+    if (elem == nullptr) {
+      continue;
+    }
+    Stats stats = elem->GetStats();
+    Console.printf("MotorSafety [%s] %s, expiration %u ms\n", elem->GetDescription().c_str(),
+                   !elem->IsSafetyEnabled() ? "disabled" : elem->IsStopped() ? "stopped" : "running",
+                   static_cast<unsigned>(elem->GetExpiration()));
+    Console.printf("  expired %u times, last at %llu ms, stopped for %llu ms\n", static_cast<unsigned>(stats.expirations),
+                   static_cast<unsigned long long>(stats.lastExpiry), static_cast<unsigned long long>(stats.stoppedTime));
+    Console.printf("  feed gaps, max %u ms:", static_cast<unsigned>(stats.maxFeedGap));
+    for (size_t i = 0; i < kFeedGapBounds.size(); ++i) {
+      Console.printf(" <%u:%u", static_cast<unsigned>(kFeedGapBounds[i]), static_cast<unsigned>(stats.feedGaps[i]));
+    }
+    Console.printf(" >=%u:%u\n", static_cast<unsigned>(kFeedGapBounds.back()), static_cast<unsigned>(stats.feedGaps.back()));
+  }
+}
+
+void MotorSafety::ResetAllStats() {
+  auto& manager = GetManager();
+  for (auto& slot : manager.instances) {
+    if (MotorSafety* elem = slot.load()) {
+      elem->ResetStats();
+    }
   }
 }
+
+void MotorSafety::Reschedule() {
+  GetManager().thread.Reschedule();
+}
@@ -1,16 +1,15 @@
 #include "chopper/drive/DifferentialDriveSabertooth.h"
 
-// void DifferentialDriveSabertooth::setup()
-// {
-//     m_saberToothDriver.setBaudRate(9600);
-//     SetRamping(80);
-//     SetExpiration(950);
-// };
+DifferentialDriveSabertooth::DifferentialDriveSabertooth(SabertoothDrive& sabertoothDrive) :
+    DifferentialDrive([&sabertoothDrive](float left, float right) { sabertoothDrive.Set(left, right); }),
+    m_sabertoothDrive(sabertoothDrive)
+{
+}
 
 void DifferentialDriveSabertooth::SetRampingValue(int ramping)
 {
-    // m_sabertoothDriver.setRamping((byte)(ramping));
     DifferentialDrive::SetRampingValue(ramping);
+    m_sabertoothDrive.SetRamping((int)m_rampingValue);
 }
 
 void DifferentialDriveSabertooth::SetDeadband(float deadband)
@@ -21,6 +20,10 @@ void DifferentialDriveSabertooth::SetDeadband(float deadband)
 
 void DifferentialDriveSabertooth::SetExpiration(uint64_t expirationTime)
 {
-    // m_sabertoothDriver.setTimeout(expirationTime);
     DifferentialDrive::SetExpiration(expirationTime);
-};
\ No newline at end of file
+}
+
+void DifferentialDriveSabertooth::SetSerialTimeout(uint64_t timeoutMs)
+{
+    m_sabertoothDrive.SetSerialTimeout(timeoutMs);
+}
@@ -26,8 +26,10 @@ SingleDrive::SingleDrive(std::function<void(float)> motor)
 {
 }
 
-void SingleDrive::ApplySpeedToMotor()
+void SingleDrive::ApplySpeedToMotor(float output)
 {
+  std::scoped_lock lock(m_outputMutex);
+  m_output = output;
   float motor = ApplySpeedLimit(m_output, m_speedLimit);
   DEBUG_DOME_PRINTF("M: %1.3f ", motor);
   m_motor(motor);
@@ -42,9 +44,7 @@ void SingleDrive::Drive(float xSpeed, bool squareInputs)
 
   float output = DriveIK(xSpeed, squareInputs);
 
-  m_output = output * m_maxOutput;
-
-  ApplySpeedToMotor();
+  ApplySpeedToMotor(output * m_maxOutput);
 }
 
 float SingleDrive::DriveIK(float xSpeed, bool squareInputs)
@@ -66,6 +66,7 @@ float SingleDrive::DriveIK(float xSpeed, bool squareInputs)
 
 void SingleDrive::StopMotor()
 {
+  std::scoped_lock lock(m_outputMutex);
   m_output = 0.0f;
 
   m_motor(0.0f);
@@ -73,6 +74,14 @@ void SingleDrive::StopMotor()
   Feed();
 }
 
+void SingleDrive::RampMotor(float scale)
+{
+  std::scoped_lock lock(m_outputMutex);
+  float motor = ApplySpeedLimit(m_output * scale, m_speedLimit);
+  DEBUG_DOME_PRINTF("Ramp M: %1.3f\n", motor);
+  m_motor(motor);
+}
+
 std::string SingleDrive::GetDescription() const
 {
   return "SingleDrive";
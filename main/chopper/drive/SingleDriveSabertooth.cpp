@@ -1,8 +1,14 @@
 #include "chopper/drive/SingleDriveSabertooth.h"
 
+SingleDriveSabertooth::SingleDriveSabertooth(SabertoothDrive& sabertoothDrive, int motorId) :
+    SingleDrive(sabertoothDrive.GetMotor(motorId)),
+    m_sabertoothDrive(sabertoothDrive)
+{
+}
 
 void SingleDriveSabertooth::SetRampingValue(int ramping) {
     SingleDrive::SetRampingValue(ramping);
+    m_sabertoothDrive.SetRamping((int)m_rampingValue);
 }
 
 void SingleDriveSabertooth::SetDeadband(float deadband)
@@ -13,4 +19,9 @@ void SingleDriveSabertooth::SetDeadband(float deadband)
 void SingleDriveSabertooth::SetExpiration(uint64_t expirationTime)
 {
     SingleDrive::SetExpiration(expirationTime);
-};
\ No newline at end of file
+}
+
+void SingleDriveSabertooth::SetSerialTimeout(uint64_t timeoutMs)
+{
+    m_sabertoothDrive.SetSerialTimeout(timeoutMs);
+}
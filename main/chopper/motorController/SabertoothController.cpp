@@ -1,6 +1,9 @@
 #include "chopper/motorController/SabertoothController.h"
 #include <Bluepad32.h>
+#include <algorithm>
+#include <cstdlib>
 #include "SettingsSystem.h"
+#include "SettingsUser.h"
 
 void SabertoothController::Set(float speed)
 {
@@ -8,10 +11,59 @@ void SabertoothController::Set(float speed)
     if (GetInverted())
         targetSpeed *= -1;
     int8_t motorSpeed = (int8_t)(targetSpeed * (int8_t)127);
-    m_sabertoothDriver->motor(m_motorId, motorSpeed);
+
+    // The drive is set every frame but the speed rarely changes between them,
+    // so skip the packet unless it changed or the keep-alive is due
+    uint64_t now = Timer::GetFPGATimestamp();
+    if (m_hasSent && motorSpeed == m_lastSpeed && now - m_lastSendTime < C110P_MOTOR_KEEPALIVE_MS)
+        return;
+
+    if (m_motorId != 1 && m_motorId != 2)
+        return;
+    // a packet the bus had no room for is tried again on the next Set()
+    if (!SendThrottle(*m_sabertoothDriver, m_arbiter, m_priority, m_motorId == 2 ? 4 : 0, motorSpeed))
+        return;
+    m_lastSpeed = motorSpeed;
+    m_lastSendTime = now;
+    m_hasSent = true;
     DEBUG_MOTOR_PRINTF("ST[%1d]:%3d ", m_motorId, motorSpeed);
 }
 
+void SabertoothController::SetArbiter(SerialBusArbiter* arbiter, SerialBusArbiter::Priority priority)
+{
+    m_arbiter = arbiter;
+    m_priority = priority;
+}
+
+bool SabertoothController::SendThrottle(const Sabertooth& driver, SerialBusArbiter* arbiter,
+                                        SerialBusArbiter::Priority priority, uint8_t command, int power)
+{
+    // same limits as Sabertooth::motor()
+    power = std::clamp(power, -126, 126);
+    if (power < 0)
+        command += 1;
+    uint8_t value = (uint8_t)std::abs(power);
+
+    if (priority == SerialBusArbiter::Priority::Drive && power == 0)
+        priority = SerialBusArbiter::Priority::DriveStop;
+    return SendCommand(driver, arbiter, priority, command, value);
+}
+
+bool SabertoothController::SendCommand(const Sabertooth& driver, SerialBusArbiter* arbiter,
+                                       SerialBusArbiter::Priority priority, uint8_t command, uint8_t value)
+{
+    if (arbiter == nullptr)
+    {
+        driver.command(command, value);
+        return true;
+    }
+
+    uint8_t address = driver.address();
+    uint8_t packet[4] = {address, command, value, (uint8_t)((address + command + value) & 0x7F)};
+    // forward and reverse share a slot so a change of direction replaces the old one
+    return arbiter->submit((uint16_t)(address << 8 | (command & ~1)), priority, packet, sizeof(packet));
+}
+
 float SabertoothController::Get() const
 {
     return m_motorId;
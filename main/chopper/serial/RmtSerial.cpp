@@ -0,0 +1,162 @@
+#include "chopper/serial/RmtSerial.h"
+#include <Bluepad32.h>
+#include <algorithm>
+#include "SettingsSystem.h"
+
+bool RmtSerial::begin(uint32_t baud, int8_t rxPin, int8_t txPin)
+{
+    end();
+
+    rmt_tx_channel_config_t channelConfig = {};
+    channelConfig.gpio_num = static_cast<gpio_num_t>(txPin);
+    channelConfig.clk_src = RMT_CLK_SRC_DEFAULT;
+    channelConfig.resolution_hz = kResolutionHz;
+    channelConfig.mem_block_symbols = 64;
+    channelConfig.trans_queue_depth = kTransactions;
+    if (rmt_new_tx_channel(&channelConfig, &_channel) != ESP_OK)
+    {
+        Console.printf("RmtSerial: no RMT channel for pin %d\n", txPin);
+        _channel = nullptr;
+        return false;
+    }
+
+    rmt_copy_encoder_config_t encoderConfig = {};
+    rmt_tx_event_callbacks_t callbacks = {};
+    callbacks.on_trans_done = onTransmitDone;
+    if (rmt_new_copy_encoder(&encoderConfig, &_encoder) != ESP_OK ||
+        rmt_tx_register_event_callbacks(_channel, &callbacks, this) != ESP_OK ||
+        rmt_enable(_channel) != ESP_OK)
+    {
+        Console.printf("RmtSerial: could not start RMT on pin %d\n", txPin);
+        end();
+        return false;
+    }
+
+    _bitTicks = static_cast<uint16_t>((kResolutionHz + baud / 2) / baud);
+    _queued = 0;
+    _done = 0;
+
+    // the channel idles low until its first transaction, so start with a
+    // frame of idle line to not look like a break
+    rmt_symbol_word_t &idle = _symbols[0][0];
+    idle.level0 = 1;
+    idle.duration0 = _bitTicks * 5;
+    idle.level1 = 1;
+    idle.duration1 = _bitTicks * 5;
+    rmt_transmit_config_t transmitConfig = {};
+    transmitConfig.flags.eot_level = 1;
+    if (rmt_transmit(_channel, _encoder, &idle, sizeof(idle), &transmitConfig) == ESP_OK)
+    {
+        ++_queued;
+    }
+
+    _hasRx = rxPin >= 0;
+    if (_hasRx)
+    {
+        _rx.begin(baud, SWSERIAL_8N1, rxPin, -1, false);
+    }
+    return true;
+}
+
+void RmtSerial::end()
+{
+    if (_channel != nullptr)
+    {
+        rmt_tx_wait_all_done(_channel, -1);
+        rmt_disable(_channel);
+        rmt_del_channel(_channel);
+        _channel = nullptr;
+    }
+    if (_encoder != nullptr)
+    {
+        rmt_del_encoder(_encoder);
+        _encoder = nullptr;
+    }
+}
+
+size_t RmtSerial::write(uint8_t byte)
+{
+    return write(&byte, 1);
+}
+
+size_t RmtSerial::write(const uint8_t *buffer, size_t size)
+{
+    size_t written = 0;
+    while (written < size)
+    {
+        size_t chunk = std::min<size_t>(size - written, kBytesPerTransaction);
+        if (!transmit(buffer + written, chunk))
+        {
+            break;
+        }
+        written += chunk;
+    }
+    return written;
+}
+
+bool RmtSerial::transmit(const uint8_t *buffer, size_t size)
+{
+    if (_channel == nullptr)
+    {
+        return false;
+    }
+
+    // every buffer is still on the wire, wait for the oldest one
+    while (_queued - _done.load() >= kTransactions)
+    {
+        vTaskDelay(1);
+    }
+
+    Symbols &symbols = _symbols[_queued % kTransactions];
+    for (size_t i = 0; i < size; ++i)
+    {
+        // start bit, data LSB first, stop bit
+        uint16_t frame = (static_cast<uint16_t>(buffer[i]) << 1) | 0x200;
+        for (uint8_t pair = 0; pair < kSymbolsPerByte; ++pair)
+        {
+            rmt_symbol_word_t &symbol = symbols[i * kSymbolsPerByte + pair];
+            symbol.level0 = (frame >> (pair * 2)) & 1;
+            symbol.duration0 = _bitTicks;
+            symbol.level1 = (frame >> (pair * 2 + 1)) & 1;
+            symbol.duration1 = _bitTicks;
+        }
+    }
+
+    rmt_transmit_config_t transmitConfig = {};
+    transmitConfig.flags.eot_level = 1;
+    if (rmt_transmit(_channel, _encoder, symbols.data(), size * kSymbolsPerByte * sizeof(rmt_symbol_word_t), &transmitConfig) != ESP_OK)
+    {
+        return false;
+    }
+    ++_queued;
+    return true;
+}
+
+bool RmtSerial::onTransmitDone(rmt_channel_handle_t channel, const rmt_tx_done_event_data_t *event, void *context)
+{
+    static_cast<RmtSerial *>(context)->_done.fetch_add(1);
+    return false;
+}
+
+int RmtSerial::available()
+{
+    return _hasRx ? _rx.available() : 0;
+}
+
+int RmtSerial::read()
+{
+    return _hasRx ? _rx.read() : -1;
+}
+
+int RmtSerial::peek()
+{
+    return _hasRx ? _rx.peek() : -1;
+}
+
+void RmtSerial::flush()
+{
+    if (_channel != nullptr)
+    {
+        rmt_tx_wait_all_done(_channel, -1);
+    }
+}
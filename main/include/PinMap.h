@@ -59,11 +59,9 @@
 #define PIN_MP3TRIGGER_RX       PIN_SCL
 #define PIN_MP3TRIGGER_TX       PIN_SDA
 
-#define PIN_MAESTRO_DOME_RX     PIN_DOUT13
-#define PIN_MAESTRO_DOME_TX     PIN_DOUT14
-
-#define PIN_MAESTRO_BODY_RX     PIN_SERIAL4_RX
-#define PIN_MAESTRO_BODY_TX     PIN_SERIAL4_TX
+// Body and dome Maestros are daisy-chained on one bus, see PololuBus.h
+#define PIN_MAESTRO_RX          PIN_SERIAL4_RX
+#define PIN_MAESTRO_TX          PIN_SERIAL4_TX
 
 #define PIN_OPENMV_RX           PIN_SERIAL2_RX
 #define PIN_OPENMV_TX           PIN_SERIAL2_TX
@@ -74,26 +72,28 @@
 #define PIN_DOME_POTENTIOMETER  PIN_DIN34
 
 // Map pins to UART ports
+// UART0 is the console and UART2 the OpenMV, the Maestro bus gets the last
+// hardware UART.  The Sabertooth transmits through RMT.
 #define UART_SABERTOOTH         sabertoothSerial
-#define UART_MAESTRO_DOME       maestroDomeSerial
-#define UART_MAESTRO_BODY       maestroBodySerial
+#define UART_MAESTRO            Serial1
 #define UART_MP3TRIGGER         mp3TriggerSerial
 #define UART_OPENMV             Serial2
 
 // Macros for initalizing the Serial Ports
 #define UART_INITIALIZE_WAIT(uart)      if (!uart) { while (1) { Console.println("Invalid Serial pin configuration, check config"); delay (1000);}} 
 
-#define UART_MAESTRO_DOME_INIT(baud)    { UART_MAESTRO_DOME.begin(baud, SWSERIAL_8N1, PIN_MAESTRO_DOME_RX, PIN_MAESTRO_DOME_TX, false); UART_INITIALIZE_WAIT(UART_MAESTRO_DOME); }
-#define UART_MAESTRO_BODY_INIT(baud)    { UART_MAESTRO_BODY.begin(baud, SWSERIAL_8N1, PIN_MAESTRO_BODY_RX, PIN_MAESTRO_BODY_TX, false); UART_INITIALIZE_WAIT(UART_MAESTRO_BODY); }
-#define UART_SABERTOOTH_INIT(baud)      { UART_SABERTOOTH.begin(baud, SWSERIAL_8N1, NOT_A_PIN, PIN_SABERTOOTH_TX, false); UART_INITIALIZE_WAIT(UART_SABERTOOTH); }
+// Hardware UART writes are queued in a TX ring buffer and sent from the FIFO interrupt
+#define UART_TX_BUFFER_SIZE             256
+
+#define UART_MAESTRO_INIT(baud)         { UART_MAESTRO.setTxBufferSize(UART_TX_BUFFER_SIZE); UART_MAESTRO.begin(baud, SERIAL_8N1, PIN_MAESTRO_RX, PIN_MAESTRO_TX); UART_INITIALIZE_WAIT(UART_MAESTRO); }
+#define UART_SABERTOOTH_INIT(baud)      { UART_SABERTOOTH.begin(baud, -1, PIN_SABERTOOTH_TX); UART_INITIALIZE_WAIT(UART_SABERTOOTH); }
 #define UART_MP3TRIGGER_INIT(baud)      { UART_MP3TRIGGER.begin(baud, SWSERIAL_8N1, PIN_MP3TRIGGER_RX, PIN_MP3TRIGGER_TX, false); delay(1500); UART_INITIALIZE_WAIT(UART_MP3TRIGGER); }
 #define UART_OPENMV_INIT(baud)          { UART_OPENMV.begin(baud, SERIAL_8N1, PIN_OPENMV_RX, PIN_OPENMV_TX); UART_INITIALIZE_WAIT(UART_OPENMV); }
 
 
 #include <SoftwareSerial.h>
-EspSoftwareSerial::UART UART_SABERTOOTH;
-EspSoftwareSerial::UART UART_MAESTRO_BODY;
-EspSoftwareSerial::UART UART_MAESTRO_DOME;
+#include "chopper/serial/RmtSerial.h"
+RmtSerial UART_SABERTOOTH;
 EspSoftwareSerial::UART UART_MP3TRIGGER;
 
 #endif
\ No newline at end of file
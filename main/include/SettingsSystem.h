@@ -1,6 +1,10 @@
 #ifndef __SETTINGS_SYSTEM_H__
 #define __SETTINGS_SYSTEM_H__
 
+// Main loop settings
+// the loop sleeps this long each pass, so a frame is at least this long
+#define LOOP_PERIOD_MS                  10
+
 // Sabertooth Settings
 #define SABERTOOTH_SERIAL_BAUD_RATE     9600
 #define SABERTOOTH_TANK_DRIVE_ID        129
@@ -8,6 +12,8 @@
 
 // Maestro Settings
 #define MAESTRO_SERIAL_BAUD_RATE        9600
+// tried fastest first at startup, see ServoDispatch::negotiateBaud()
+#define MAESTRO_SERIAL_BAUD_RATES       {200000, 115200, 57600, 38400, 19200, 9600}
 #define MAESTRO_BODY_ID                 12
 #define MAESTRO_DOME_ID                 13
 
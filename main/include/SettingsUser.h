@@ -8,9 +8,28 @@
 // each message from the controller resets the timer
 #define C110P_MOTOR_SAFETY_TIMEOUT_MS   500    
 
-// setTimeout rounds up to the nearest 100 milliseconds
-// A value of 0 disables the serial timeout
-#define C110P_MOTOR_SERIAL_TIMEOUT_MS   450     
+// duration in milliseconds the motors ramp down over once the safety timeout
+// expires, instead of stopping dead, a value of 0 stops them at once
+#define C110P_MOTOR_SAFETY_RAMP_MS      250
+
+// duration in milliseconds without a command before the Sabertooth and SyRen
+// stop their motors by themselves, even if the ESP32 has hung
+// kept longer than the safety timeout above so the firmware stops them first
+// rounds up to the nearest 100 milliseconds, a value of 0 disables the serial timeout
+#define C110P_MOTOR_SERIAL_TIMEOUT_MS   (C110P_MOTOR_SAFETY_TIMEOUT_MS + 200)
+
+// motor commands are only sent when they change, an unchanged command is
+// resent this often so neither timeout above stops a motor that is holding speed
+#define C110P_MOTOR_KEEPALIVE_MS        (C110P_MOTOR_SAFETY_TIMEOUT_MS / 4)
+
+#if C110P_MOTOR_SERIAL_TIMEOUT_MS > 0 && C110P_MOTOR_SERIAL_TIMEOUT_MS <= C110P_MOTOR_KEEPALIVE_MS
+#error "C110P_MOTOR_SERIAL_TIMEOUT_MS must be longer than C110P_MOTOR_KEEPALIVE_MS or a motor holding speed stops"
+#endif
+
+// bytes the Sabertooth and SyRen may share on their serial line each loop:
+// what the baud rate carries in one loop (10 bits a byte), in whole 4 byte commands
+// 9600 baud is 9.6 bytes per 10ms loop, so 8
+#define C110P_MOTOR_BUS_BYTES_PER_FRAME (SABERTOOTH_SERIAL_BAUD_RATE / 10 * LOOP_PERIOD_MS / 1000 / 4 * 4)
 
 
 /*
@@ -20,6 +39,7 @@
 //       1-10: Fast         = 256/(~1000 * COMMAND_VALUE)
 //      11-20: Slow         = 256/(15.25 * (COMMAND_VALUE - 10))
 //      21-80: Intermediate = 256/(15.25 * (COMMAND_VALUE - 10))
+// programmed into the Sabertooth at boot, which keeps it between power cycles
 #define C110P_DRIVE_RAMPING_PERIOD      80      
 
 // Top speed limiter - percentage 0.0 - 1.0
@@ -29,6 +49,9 @@
 #define C110P_DRIVE_DEADBAND            0.05f
 #define C110P_DRIVE_MOTOR_1_INVERTED   true
 #define C110P_DRIVE_MOTOR_2_INVERTED   false
+// let the Sabertooth mix drive and turn, so both motors change on the same packet
+// motor 1 = drive + turn, motor 2 = drive - turn
+#define C110P_DRIVE_MIXED_MODE         false
 
 /*
     DOME settings
@@ -37,6 +60,7 @@
 //       1-10: Fast         = 256/(~1000 * COMMAND_VALUE)
 //      11-20: Slow         = 256/(15.25 * (COMMAND_VALUE - 10))
 //      21-80: Intermediate = 256/(15.25 * (COMMAND_VALUE - 10))
+// programmed into the SyRen at boot, which keeps it between power cycles
 #define C110P_DOME_RAMPING_PERIOD      80      
 
 // Dome speed limiter - percentage 0.0 - 1.0
@@ -48,6 +72,25 @@
 #define DOME_DIRECTION_CHANGE_THRESHOLD 5
 #define DOME_RANDOM_MOVE_MIN_DEGREES 5
 
+/*
+    SERVO settings
+*/
+// duration in milliseconds a servo holds position after finishing a move 
+// before its PWM signal is stopped to prevent searching/jitter
+#define C110P_SERVO_IDLE_HOLD_MS            1000
+
+// current in milliamps the BEC powering each Maestro can supply
+// moves which would exceed this are deferred until other servos power down
+#define C110P_SERVO_BODY_BEC_BUDGET_MA      3000
+#define C110P_SERVO_DOME_BEC_BUDGET_MA      3000
+
+// append a CRC-7 to every Maestro command so a corrupted frame is dropped
+// instead of moving a servo, must match "Enable CRC" in the Maestro Control
+// Center serial settings of both Maestros
+#define C110P_SERVO_CRC_ENABLED             true
+// how often in milliseconds each Maestro's error register is read back
+#define C110P_SERVO_ERROR_POLL_MS           1000
+
 /*
     CONTROLLER settings
 */
@@ -129,6 +172,19 @@
 #define C110P_RSS_MECHANISM_BEND_OUT              true
 #define C110P_RSS_MECHANISM_ACTUATION_RANGE       270
 #define C110P_RSS_MECHANISM_ROTATION_OFFSET       -30.0f
+// Per-leg PWM offsets generated by tools/rss_calibrate, used instead of the
+// estimate from the MAESTRO_BODY_NECK_*_MIN/MAX pulses when all three are set
+// #define C110P_RSS_MECHANISM_LEG_OFFSET_PWM_A   0
+// #define C110P_RSS_MECHANISM_LEG_OFFSET_PWM_B   0
+// #define C110P_RSS_MECHANISM_LEG_OFFSET_PWM_C   0
+// Pose changes are planned in ticks of this many milliseconds
+#define C110P_RSS_MECHANISM_PLANNER_TICK_MS       10
+// Tilt (normal vector units) per second, and per second²
+#define C110P_RSS_MECHANISM_TILT_VELOCITY         1.0f
+#define C110P_RSS_MECHANISM_TILT_ACCELERATION     6.0f
+// Height (mm) per second, and per second²
+#define C110P_RSS_MECHANISM_HEIGHT_VELOCITY       40.0f
+#define C110P_RSS_MECHANISM_HEIGHT_ACCELERATION   120.0f
 
 /*
     SOUND settings
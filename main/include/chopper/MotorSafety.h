@@ -4,24 +4,55 @@
 
 #pragma once
 
+#include <array>
+#include <atomic>
+#include <functional>
 #include <string>
 
-// #include <units.h>
 #include <wpi/mutex.h>
 
+// #include <units.h>
+
 #include "chopper/Timer.h"
 
 /**
  * The Motor Safety feature acts as a watchdog timer for an individual motor. It
  * operates by maintaining a timer that tracks how long it has been since the
- * feed() method has been called for that actuator. Code in the Driver Station
- * class initiates a comparison of these timers to the timeout values for any
- * actuator with safety enabled every 5 received packets (100ms nominal).
+ * feed() method has been called for that actuator. A watchdog thread keeps the
+ * stop times of every actuator with safety enabled in a min-heap, and sleeps
+ * until the earliest one, so a motor is stopped within a tick of expiring.
+ *
+ * With a stop ramp set, an expired motor is ramped down by the watchdog
+ * thread on its own timing rather than stopped at once, then stays latched
+ * stopped until the next Feed() from fresh input.
  *
  * The subclass should call Feed() whenever the motor value is updated.
  */
 class MotorSafety {
  public:
+  /// Upper bounds in milliseconds of the feed gap histogram buckets, the
+  /// last bucket counts every gap from the last bound up.
+  static constexpr std::array<uint32_t, 7> kFeedGapBounds = {10, 20, 50, 100, 200, 500, 1000};
+
+  /// Milliseconds between the steps of a ramp down, see SetStopRamp().
+  static constexpr uint32_t kRampStepMs = 20;
+
+  /**
+   * Watchdog statistics of one motor, all times in milliseconds.
+   */
+  struct Stats {
+    /// Times the motor expired and was stopped by the watchdog.
+    uint32_t expirations;
+    /// Longest time between two Feed() calls.
+    uint32_t maxFeedGap;
+    /// Time between Feed() calls, counted in kFeedGapBounds buckets.
+    std::array<uint32_t, kFeedGapBounds.size() + 1> feedGaps;
+    /// Time spent ramping down or latched stopped.
+    uint64_t stoppedTime;
+    /// FPGA timestamp of the last expiration, 0 if it never expired.
+    uint64_t lastExpiry;
+  };
+
   MotorSafety();
   virtual ~MotorSafety();
 
@@ -74,6 +105,40 @@ class MotorSafety {
    */
   bool IsSafetyEnabled() const;
 
+  /**
+   * Ramp the motor down when it expires instead of stopping it at once.
+   *
+   * The watchdog thread scales the last output from full to 0 over the ramp
+   * time, one step every kRampStepMs, so the stop completes in a bounded time
+   * however stalled the main loop is.
+   *
+   * @param rampTime Duration of the ramp in milliseconds, 0 stops at once.
+   * @param flush    Called by the watchdog after each step, to put the
+   *                 command on the wire without waiting for the main loop.
+   *                 Best set before safety is enabled, it is swapped under a
+   *                 lock if the watchdog is already running it.
+   */
+  void SetStopRamp(uint64_t rampTime, std::function<void()> flush = nullptr);
+
+  /**
+   * Determine if the motor was stopped by the watchdog.
+   *
+   * @return true from the expiration, through the ramp down, until the motor
+   *         is fed by fresh input again.
+   */
+  bool IsStopped() const;
+
+  /**
+   * Returns the watchdog statistics gathered since boot or the last reset.
+   */
+  Stats GetStats() const;
+
+  /**
+   * Clears the watchdog statistics.  A stop still going on is counted from
+   * the reset.
+   */
+  void ResetStats();
+
   /**
    * Check if this motor has exceeded its timeout.
    *
@@ -91,6 +156,29 @@ class MotorSafety {
    */
   static void CheckMotors();
 
+  /**
+   * Check the motors whose stop time has passed.
+   *
+   * Called by the watchdog thread each time it wakes.  Only the instances at
+   * the top of the deadline heap are looked at, a deadline that was fed
+   * since it was queued goes back in the heap at its new stop time.
+   *
+   * @param rebuild Rebuild the heap from every instance, after a stop time
+   *                moved earlier or an instance was added or enabled.
+   * @return The next stop time, UINT64_MAX if there is none.
+   */
+  static uint64_t CheckDeadlines(bool rebuild);
+
+  /**
+   * Prints the statistics of every motor to the console.
+   */
+  static void PrintAllStats();
+
+  /**
+   * Clears the statistics of every motor.
+   */
+  static void ResetAllStats();
+
   /**
    * Called to stop the motor when the timeout expires.
    */
@@ -103,18 +191,58 @@ class MotorSafety {
    */
   virtual std::string GetDescription() const = 0;
 
+  /**
+   * Called by the watchdog to ramp the motor down.  Scales the output of the
+   * last command, reaching 0 at the end of the ramp.  Must not call Feed(),
+   * which is taken as fresh input and ends the ramp.
+   *
+   * The default stops the motor at the end of the ramp.
+   *
+   * @param scale Fraction of the last output to apply, 1.0 to 0.0.
+   */
+  virtual void RampMotor(float scale);
+
  private:
   // measured in milliseconds
   static constexpr auto kDefaultSafetyExpiration = 1000;
 
+  enum State : uint8_t { kRunning, kRamping, kStopped };
+
+  // Stored in atomics so Feed() and IsAlive() never wait on the watchdog
+  // thread.  32 bits wide to be lock-free on the ESP32, the stop time wraps
+  // and is compared by its distance to now.
+
   // The expiration time for this object
-  uint64_t m_expiration = kDefaultSafetyExpiration;
+  std::atomic<uint32_t> m_expiration{kDefaultSafetyExpiration};
 
   // True if motor safety is enabled for this motor
-  bool m_enabled = false;
+  std::atomic<bool> m_enabled{false};
 
   // The FPGA clock value when the motor has expired
-  uint64_t m_stopTime = Timer::GetFPGATimestamp();
-
-  mutable wpi::mutex m_thisMutex;
+  std::atomic<uint32_t> m_stopTime{static_cast<uint32_t>(Timer::GetFPGATimestamp())};
+
+  // Set to kRunning by Feed(), the watchdog moves it on to kRamping and kStopped
+  std::atomic<uint8_t> m_state{kRunning};
+
+  // Stop ramp, and when the current one started (watchdog thread only)
+  std::atomic<uint32_t> m_rampTime{0};
+  uint32_t m_rampStart = 0;
+  // the flush is set from the main loop while the watchdog may be calling it
+  wpi::mutex m_rampMutex;
+  std::function<void()> m_rampFlush;
+
+  // Statistics, see Stats
+  std::atomic<uint32_t> m_expirations{0};
+  std::atomic<uint32_t> m_maxFeedGap{0};
+  std::array<std::atomic<uint32_t>, kFeedGapBounds.size() + 1> m_feedGaps{};
+  std::atomic<uint32_t> m_stoppedTime{0};
+  // when the motor last expired, and so when the current stop started
+  std::atomic<uint32_t> m_lastExpiry{0};
+  std::atomic<uint32_t> m_lastFeed{0};
+  std::atomic<bool> m_hasFed{false};
+
+  void RecordFeedGap(uint32_t gap);
+
+  // Wakes the watchdog thread when a stop time may have moved earlier
+  static void Reschedule();
 };
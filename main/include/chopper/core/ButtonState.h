@@ -20,7 +20,7 @@ public:
     };
 
     ButtonState() 
-        : state_(0), is_pressed(false), last_press_time(0), double_click_threshold_ms(500) {}
+        : state_(0), is_pressed(false), last_press_time(0), last_down_time(0), double_click_threshold_ms(500) {}
 
     operator bool() const { return isPressed(); }
 
@@ -35,6 +35,7 @@ public:
         {
             if (!is_pressed)
             {
+                last_down_time = currentMillis;
                 auto time_since_last_press = currentMillis - last_press_time;
                 if (time_since_last_press <= double_click_threshold_ms)
                 {
@@ -62,6 +63,12 @@ public:
         return last_press_time;
     }
 
+    // Time of the latest press, including the second press of a double click
+    uint64_t lastDownTime() const
+    {
+        return last_down_time;
+    }
+
     uint64_t lastReleaseTime() const
     {
         return last_release_time;
@@ -94,6 +101,7 @@ public:
 private:
     int double_click_threshold_ms;
     uint64_t last_press_time;
+    uint64_t last_down_time;
     uint64_t last_release_time;
     bool is_pressed;
     uint8_t state_;              // Bitmask for button state
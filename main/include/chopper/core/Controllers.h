@@ -14,6 +14,7 @@
 #include "chopper/dome/DomePosition.h"
 #include "chopper/filter/SlewRateLimiter.h"
 #include "chopper/servo/Dispatch.h"
+#include "chopper/servo/ServoSyncGroup.h"
 #include "settings/ServoPinMap.h"
 #include "settings/ServoPWM.h"
 #include "chopper/servo/RSSMechanism.h"
@@ -90,6 +91,11 @@ public:
         {
             delete it->second; // Free the allocated memory
             _ctls.erase(it); // Remove the entry from the map
+            if (*optRole == ControllerRoles::Dome)
+            {
+                // the neck eases back to level rather than holding the last tilt
+                _rssJoystick = {0.0f, 0.0f};
+            }
             DEBUG_CONTROLLER_PRINTF("Controller of role %d deleted successfully\n", *optRole);
         }
         else
@@ -157,16 +163,12 @@ public:
                 // move full left, without stopping in center
                 if (m_periscopeLocation != -1)
                 {
-                    _maestroDome->setTimedMovement(
-                        MAESTRO_DOME_PERISCOPE_SPIN,
+                    movePeriscopeSpin(
                         MAESTRO_DOME_PERISCOPE_SPIN_MIN,
                         MAESTRO_DOME_PERISCOPE_SPIN_MAX,
                         ctlDrive->getButtonState("a").lastPressTime(),
-                        800);
-                    if (_maestroDome->isFinishedMoving(MAESTRO_DOME_PERISCOPE_SPIN))
-                    {
-                        m_periscopeLocation = -1;
-                    }
+                        800,
+                        -1);
                 }
             }
             else if (ctlDrive->a())
@@ -178,30 +180,22 @@ public:
                     if (m_periscopeLocation == 0)
                     {
                         // facing center, asked to move left
-                        _maestroDome->setTimedMovement(
-                            MAESTRO_DOME_PERISCOPE_SPIN,
+                        movePeriscopeSpin(
                             MAESTRO_DOME_PERISCOPE_SPIN_NEUTRAL,
                             MAESTRO_DOME_PERISCOPE_SPIN_MAX,
                             ctlDrive->getButtonState("a").lastPressTime(),
-                            400);
-                        if (_maestroDome->isFinishedMoving(MAESTRO_DOME_PERISCOPE_SPIN))
-                        {
-                            m_periscopeLocation = -1;
-                        }
+                            400,
+                            -1);
                     }
                     else if (m_periscopeLocation == 1)
                     {
                         // facing right, asked to move left
-                        _maestroDome->setTimedMovement(
-                            MAESTRO_DOME_PERISCOPE_SPIN,
+                        movePeriscopeSpin(
                             MAESTRO_DOME_PERISCOPE_SPIN_MIN,
                             MAESTRO_DOME_PERISCOPE_SPIN_NEUTRAL,
                             ctlDrive->getButtonState("a").lastPressTime(),
-                            400);
-                        if (_maestroDome->isFinishedMoving(MAESTRO_DOME_PERISCOPE_SPIN))
-                        {
-                            m_periscopeLocation = 0;
-                        }
+                            400,
+                            0);
                     }
                     else if (m_periscopeLocation == -1)
                     {
@@ -217,8 +211,7 @@ public:
             DEBUG_CONTROLLER_PRINTLN("Dpad Down");
             // Toggle Body Arm out/in based on how long the button has been held
             // Move full range defined on Maestro in 800ms
-            // TODO: handle press for half the time, release for a quarter, then press again 
-            // .. it should start moving where it left off after the release finished
+            // Releasing part way and pressing again picks up from the current position and speed
             _maestroBody->setTimedMovement(
                 MAESTRO_UTILITY_ARM, 
                 MAESTRO_UTILITY_ARM_NEUTRAL, 
@@ -246,30 +239,22 @@ public:
             if (m_periscopeDown)
             {
                 DEBUG_CONTROLLER_PRINTLN("Periscope moving up");
-                _maestroDome->setTimedMovement(
-                    MAESTRO_DOME_PERISCOPE_LIFT,
+                movePeriscopeLift(
                     MAESTRO_DOME_PERISCOPE_LIFT_MIN,
                     MAESTRO_DOME_PERISCOPE_LIFT_MAX,
                     ctlDrive->getButtonState("x").lastPressTime(),
-                    800);
-                if (_maestroDome->isFinishedMoving(MAESTRO_DOME_PERISCOPE_LIFT))
-                {
-                    m_periscopeDown = false;
-                }
+                    800,
+                    false);
             }
             else
             {
                 DEBUG_CONTROLLER_PRINTLN("Periscope moving down");
-                _maestroDome->setTimedMovement(
-                    MAESTRO_DOME_PERISCOPE_LIFT,
+                movePeriscopeLift(
                     MAESTRO_DOME_PERISCOPE_LIFT_MAX,
                     MAESTRO_DOME_PERISCOPE_LIFT_MIN,
                     ctlDrive->getButtonState("x").lastPressTime(),
-                    800);
-                if (_maestroDome->isFinishedMoving(MAESTRO_DOME_PERISCOPE_LIFT))
-                {
-                    m_periscopeDown = true;
-                }
+                    800,
+                    true);
             }
         }
         
@@ -282,16 +267,12 @@ public:
                 // move full right, without stopping in center
                 if (m_periscopeLocation != 1)
                 {
-                    _maestroDome->setTimedMovement(
-                        MAESTRO_DOME_PERISCOPE_SPIN,
+                    movePeriscopeSpin(
                         MAESTRO_DOME_PERISCOPE_SPIN_MAX,
                         MAESTRO_DOME_PERISCOPE_SPIN_MIN,
                         ctlDrive->getButtonState("y").lastPressTime(),
-                        800);
-                    if (_maestroDome->isFinishedMoving(MAESTRO_DOME_PERISCOPE_SPIN))
-                    {
-                        m_periscopeLocation = 1;
-                    }
+                        800,
+                        1);
                 }
             }
             else if (ctlDrive->y())
@@ -303,16 +284,12 @@ public:
                     if (m_periscopeLocation == 0)
                     {
                         // facing center, asked to move right
-                        _maestroDome->setTimedMovement(
-                            MAESTRO_DOME_PERISCOPE_SPIN,
+                        movePeriscopeSpin(
                             MAESTRO_DOME_PERISCOPE_SPIN_NEUTRAL,
                             MAESTRO_DOME_PERISCOPE_SPIN_MIN,
                             ctlDrive->getButtonState("y").lastPressTime(),
-                            400);
-                        if (_maestroDome->isFinishedMoving(MAESTRO_DOME_PERISCOPE_SPIN))
-                        {
-                            m_periscopeLocation = 1;
-                        }
+                            400,
+                            1);
                     }
                     else if (m_periscopeLocation == 1)
                     {
@@ -322,16 +299,12 @@ public:
                     else if (m_periscopeLocation == -1)
                     {
                         // facing left, asked to move right
-                        _maestroDome->setTimedMovement(
-                            MAESTRO_DOME_PERISCOPE_SPIN,
+                        movePeriscopeSpin(
                             MAESTRO_DOME_PERISCOPE_SPIN_MAX,
                             MAESTRO_DOME_PERISCOPE_SPIN_NEUTRAL,
                             ctlDrive->getButtonState("y").lastPressTime(),
-                            400);
-                        if (_maestroDome->isFinishedMoving(MAESTRO_DOME_PERISCOPE_SPIN))
-                        {
-                            m_periscopeLocation = 0;
-                        }
+                            400,
+                            0);
                     }
                 }
             }
@@ -379,50 +352,26 @@ public:
         if (isCtlDriveValid && ctlDrive->miscSelect())
         {
             DEBUG_CONTROLLER_PRINTLN("-");
-           // Toggle Right Dome Door Open/Closed
-            if (m_rightDomeDoorOpen)
-            {
-                DEBUG_CONTROLLER_PRINTLN("RightDomeDoorOpen");
-                _maestroDome->setTimedMovement(
-                    MAESTRO_DOME_DOOR_RIGHT,
-                    MAESTRO_DOME_DOOR_RIGHT_MAX,
-                    MAESTRO_DOME_DOOR_RIGHT_MIN,
-                    ctlDrive->getButtonState("miscSelect").lastPressTime(),
-                    1);
-                m_rightDomeDoorOpen = false;
-            }
-            else
-            {
-                DEBUG_CONTROLLER_PRINTLN("RightDoorClosed");
-                _maestroDome->setTimedMovement(
-                    MAESTRO_DOME_DOOR_RIGHT,
-                    MAESTRO_DOME_DOOR_RIGHT_MIN,
-                    MAESTRO_DOME_DOOR_RIGHT_MAX,
-                    ctlDrive->getButtonState("miscSelect").lastPressTime(),
-                    1);
-                m_rightDomeDoorOpen = true;
-            }
-            if (m_leftDomeDoorOpen)
-            {
-                DEBUG_CONTROLLER_PRINTLN("LeftDomeDoorOpen");
-                _maestroDome->setTimedMovement(
-                    MAESTRO_DOME_DOOR_LEFT,
-                    MAESTRO_DOME_DOOR_LEFT_NEUTRAL,
-                    MAESTRO_DOME_DOOR_LEFT_MAX,
-                    ctlDrive->getButtonState("miscSelect").lastPressTime(),
-                    1);
-                m_leftDomeDoorOpen = false;
-            }
-            else
+            // Toggle both Dome Doors Open/Closed as one move
+            bool closeRight = m_rightDomeDoorOpen;
+            bool closeLeft = m_leftDomeDoorOpen;
+            uint16_t rightClosed = MAESTRO_DOME_DOOR_RIGHT_MIN;
+            uint16_t rightOpen = MAESTRO_DOME_DOOR_RIGHT_MAX;
+            uint16_t leftClosed = MAESTRO_DOME_DOOR_LEFT_MAX;
+            uint16_t leftOpen = MAESTRO_DOME_DOOR_LEFT_NEUTRAL;
+            bool isPlanned = _domeDoors.start(
+                {
+                    {_maestroDome, MAESTRO_DOME_DOOR_RIGHT, closeRight ? rightOpen : rightClosed, closeRight ? rightClosed : rightOpen},
+                    {_maestroDome, MAESTRO_DOME_DOOR_LEFT, closeLeft ? leftOpen : leftClosed, closeLeft ? leftClosed : leftOpen}
+                },
+                ctlDrive->getButtonState("miscSelect").lastPressTime(),
+                1,
+                []() { DEBUG_CONTROLLER_PRINTLN("Dome doors finished moving"); });
+            if (isPlanned)
             {
-                DEBUG_CONTROLLER_PRINTLN("LeftDoorClosed");
-                _maestroDome->setTimedMovement(
-                    MAESTRO_DOME_DOOR_LEFT,
-                    MAESTRO_DOME_DOOR_LEFT_MAX,
-                    MAESTRO_DOME_DOOR_LEFT_NEUTRAL,
-                    ctlDrive->getButtonState("miscSelect").lastPressTime(),
-                    1);
-                m_leftDomeDoorOpen = true;
+                DEBUG_CONTROLLER_PRINTF("Right dome door %s, left dome door %s\n", closeRight ? "closing" : "opening", closeLeft ? "closing" : "opening");
+                m_rightDomeDoorOpen = !closeRight;
+                m_leftDomeDoorOpen = !closeLeft;
             }
         }
     
@@ -467,14 +416,30 @@ public:
             _mp3Trigger->trigger(C110P_SOUND_MANDOLORIAN);
         }
     
-        if (isCtlDomeValid && ctlDome->x())
+        if (isCtlDomeValid && ctlDome->x().isDoubleClicked())
+        {
+            DEBUG_CONTROLLER_PRINTLN("B -- double click");
+            if (isNewPress(ctlDome->getButtonState("x"), m_gesturePressX))
+            {
+                _rssMachine->playGesture(RSSGesture::Type::Tilt);
+            }
+        }
+        else if (isCtlDomeValid && ctlDome->x())
         {
             DEBUG_CONTROLLER_PRINTLN("B");
+            if (isNewPress(ctlDome->getButtonState("x"), m_gesturePressX))
+            {
+                _rssMachine->playGesture(RSSGesture::Type::Nod);
+            }
         }
         
         if (isCtlDomeValid && ctlDome->y())
         {
             DEBUG_CONTROLLER_PRINTLN("Y"); 
+            if (isNewPress(ctlDome->getButtonState("y"), m_gesturePressY))
+            {
+                _rssMachine->playGesture(RSSGesture::Type::LookAround);
+            }
         }
     
         if (isCtlDomeValid && ctlDome->l1())
@@ -503,6 +468,10 @@ public:
         if (isCtlDomeValid && ctlDome->miscSelect())
         {
             DEBUG_CONTROLLER_PRINTLN("Home");
+            if (isNewPress(ctlDome->getButtonState("miscSelect"), m_gesturePressHome))
+            {
+                _rssMachine->playGesture(RSSGesture::Type::Curious);
+            }
         }
     
         if (isCtlDomeValid && ctlDome->miscStart())
@@ -520,6 +489,11 @@ public:
             }
             else
             {
+                _rssMachine->syncPose({
+                    _maestroBody->getPosition(MAESTRO_BODY_NECK_A),
+                    _maestroBody->getPosition(MAESTRO_BODY_NECK_B),
+                    _maestroBody->getPosition(MAESTRO_BODY_NECK_C)
+                });
                 _rssMachine->setEnabled(true);
             }
         }
@@ -532,13 +506,29 @@ public:
 
         if (isCtlDomeValid)
         {
-            // Process joystick for RSSMachine
-            processRSSMachine(ctlDome);
+            // Joystick for RSSMachine, followed every loop by update()
+            _rssJoystick = {ctlDome->axisXslew(), ctlDome->axisYslew()};
+            _hasRSSInput = true;
         }
-    
+    }
+
+    // Runs once per loop, whether or not the controllers sent anything, so
+    // timed moves finish and idle servos power down while they are quiet
+    void update()
+    {
+        // the neck planner and gestures run on time, from the last joystick
+        // input until the next report
+        if (_hasRSSInput)
+        {
+            processRSSMachine();
+        }
+
         // Process Servo motions all at once
         _maestroBody->animate();
         _maestroDome->animate();
+        _domeDoors.update();
+        _periscopeLift.update();
+        _periscopeSpin.update();
 
         // We need to update the state of the MP3Trigger each clock cycle
         // ref: https://learn.sparkfun.com/tutorials/mp3-trigger-hookup-guide-v24
@@ -634,13 +624,39 @@ private:
         DEBUG_DOME_PRINTF("Dome Position: %4d\n", _domeSensor->getDomePosition());
     }
 
-    void processRSSMachine(ControllerDecoratorPtr ctl)
+    void movePeriscopeLift(uint16_t startPosition, uint16_t finishPosition, uint64_t startTime, uint32_t duration, bool isDown)
     {
-        std::array<uint16_t, 3> legs = _rssMachine->getLegPWMFromJoystick(
-            // The oreintation of the JoyCon has the X and Y swapped
-            ctl->axisXslew(),
-            ctl->axisYslew()
-        );
+        _periscopeLift.start(
+            {{_maestroDome, MAESTRO_DOME_PERISCOPE_LIFT, startPosition, finishPosition}},
+            startTime,
+            duration,
+            [this, isDown]() { m_periscopeDown = isDown; });
+    }
+
+    void movePeriscopeSpin(uint16_t startPosition, uint16_t finishPosition, uint64_t startTime, uint32_t duration, int8_t location)
+    {
+        _periscopeSpin.start(
+            {{_maestroDome, MAESTRO_DOME_PERISCOPE_SPIN, startPosition, finishPosition}},
+            startTime,
+            duration,
+            [this, location]() { m_periscopeLocation = location; });
+    }
+
+    // True on the first frame of each press, however long the button is held
+    static bool isNewPress(const ButtonState& button, uint64_t& lastDownTime)
+    {
+        if (button.lastDownTime() == lastDownTime)
+        {
+            return false;
+        }
+        lastDownTime = button.lastDownTime();
+        return true;
+    }
+
+    void processRSSMachine()
+    {
+        // The oreintation of the JoyCon has the X and Y swapped
+        std::array<uint16_t, 3> legs = _rssMachine->getLegPWMFromJoystick(_rssJoystick[0], _rssJoystick[1]);
 
         _maestroBody->setPosition(MAESTRO_BODY_NECK_A, legs[0]);
         _maestroBody->setPosition(MAESTRO_BODY_NECK_B, legs[1]);
@@ -661,10 +677,20 @@ private:
     ServoDispatch* _maestroDome = nullptr;
     RSSMechanism* _rssMachine = nullptr;
     SlewRateLimiter* _domeSpinSlewRateLimiter = nullptr;
+    ServoSyncGroup _domeDoors;
+    ServoSyncGroup _periscopeLift;
+    ServoSyncGroup _periscopeSpin;
+    // last dome joystick, and whether the dome controller has sent any yet
+    std::array<float, 2> _rssJoystick = {0.0f, 0.0f};
+    bool _hasRSSInput = false;
     bool m_periscopeDown = true;
     bool m_rightDomeDoorOpen = true;
     bool m_leftDomeDoorOpen = true;
     int8_t m_periscopeLocation = 0;
     bool m_isCarpetMode = false;
+    // press that started the last gesture from each button, see isNewPress()
+    uint64_t m_gesturePressX = 0;
+    uint64_t m_gesturePressY = 0;
+    uint64_t m_gesturePressHome = 0;
     int16_t m_volume = 0;
 };
@@ -0,0 +1,236 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include "include/chopper/dome/RSSKinematics.h"
+
+/*
+    Platform pose of the RSS neck in the same terms the joystick uses:
+    tilt (nx, ny) before normalizing against nz = 1, and height hz above
+    the base.
+*/
+struct RSSPose
+{
+    float nx;
+    float ny;
+    float hz;
+};
+
+/*
+    Forward kinematics for the 3-RSS neck: leg angles to platform pose.
+
+    There is no closed form, so this runs a few Newton iterations on the
+    loop-closure error of the inverse kinematics kernel, with the Jacobian
+    taken by finite differences.  The kernel is passed in to each solve
+    rather than held, so the owner can be copied or moved freely.  The closure error stays smooth where the
+    leg angles do not (a leg at full extension, which is where projected 
+    poses often end up), so Newton keeps converging there.  Each solve is 
+    warm-started from the last one.  The neck only moves a little between 
+    frames, so one or two iterations are usually enough.
+
+    The pose is parameterized by tilt rather than the unit normal, so every
+    (nx, ny) is a valid orientation and no step can leave the sphere.
+*/
+class RSSForwardKinematics
+{
+public:
+    struct Result
+    {
+        RSSPose pose;
+        // worst leg closure error, in the same units as the links
+        float residual;
+        uint8_t iterations;
+        bool converged;
+    };
+
+    static constexpr uint8_t kMaxIterations = 6;
+    // ~0.01 degrees at the knee, well below what a servo can resolve
+    static constexpr float kTolerance = 0.005f;
+
+    RSSForwardKinematics() = default;
+
+    ~RSSForwardKinematics() = default;
+
+    // Heights the search may step through, also seeds a level pose between them
+    void setHeightLimits(float minHeight, float maxHeight)
+    {
+        _minHeight = minHeight;
+        _maxHeight = maxHeight;
+        _lastPose = levelPose();
+    }
+
+    // Leg angles in degrees
+    Result solve(const RSSKinematics &kinematics, const std::array<float, 3> &angles)
+    {
+        std::array<float, 3> cosAngles;
+        std::array<float, 3> sinAngles;
+        for (size_t leg = 0; leg < angles.size(); ++leg)
+        {
+            const float radians = angles[leg] * kDeg2Rad;
+            cosAngles[leg] = std::cos(radians);
+            sinAngles[leg] = std::sin(radians);
+        }
+
+        Result result = newton(kinematics, _lastPose, cosAngles, sinAngles);
+        result.converged = result.converged && matches(kinematics, result.pose, angles);
+        if (!result.converged)
+        {
+            // a long way from the last pose, or it led to another assembly of
+            // the linkage; start again from level
+            Result retry = newton(kinematics, levelPose(), cosAngles, sinAngles);
+            retry.iterations += result.iterations;
+            retry.converged = retry.converged && matches(kinematics, retry.pose, angles);
+            if (retry.converged || retry.residual < result.residual)
+            {
+                result = retry;
+            }
+        }
+        if (result.converged)
+        {
+            _lastPose = result.pose;
+        }
+        return result;
+    }
+
+    // Seeds the next solve, e.g. with a pose that was just commanded
+    void reset(const RSSPose &pose)
+    {
+        _lastPose = pose;
+    }
+
+private:
+    static constexpr float kDeg2Rad = static_cast<float>(M_PI / 180.0);
+    static constexpr float kTiltStep = 1e-3f;
+    static constexpr float kHeightStep = 0.05f;
+    static constexpr float kMaxTiltStep = 0.1f;
+    static constexpr float kMaxHeightStep = 5.0f;
+    static constexpr uint8_t kMaxBacktracks = 4;
+    // degrees, loose enough for the rounding near full extension
+    static constexpr float kBranchTolerance = 0.5f;
+
+    RSSPose levelPose() const
+    {
+        return {0.0f, 0.0f, (_minHeight + _maxHeight) / 2.0f};
+    }
+
+    Result newton(const RSSKinematics &kinematics, const RSSPose &seed,
+        const std::array<float, 3> &cosAngles, const std::array<float, 3> &sinAngles) const
+    {
+        RSSPose pose = seed;
+        std::array<float, 3> residual = error(kinematics, pose, cosAngles, sinAngles);
+        Result result = {pose, worst(residual), 0, false};
+
+        while (result.residual > kTolerance && result.iterations < kMaxIterations)
+        {
+            ++result.iterations;
+
+            // columns are d(error)/d(nx), d(error)/d(ny), d(error)/d(hz)
+            float jacobian[3][3];
+            const float steps[3] = {kTiltStep, kTiltStep, kHeightStep};
+            for (uint8_t axis = 0; axis < 3; ++axis)
+            {
+                RSSPose probe = pose;
+                (axis == 0 ? probe.nx : axis == 1 ? probe.ny : probe.hz) += steps[axis];
+                std::array<float, 3> shifted = error(kinematics, probe, cosAngles, sinAngles);
+                for (uint8_t leg = 0; leg < 3; ++leg)
+                {
+                    jacobian[leg][axis] = (shifted[leg] - residual[leg]) / steps[axis];
+                }
+            }
+
+            float delta[3];
+            if (!solve3x3(jacobian, residual, delta))
+            {
+                break;
+            }
+
+            // far from the answer a full step can overshoot, so limit it 
+            // and back off until the residual improves
+            float scale = std::min({1.0f,
+                kMaxTiltStep / std::max(std::fabs(delta[0]), std::fabs(delta[1])),
+                kMaxHeightStep / std::fabs(delta[2])});
+            bool improved = false;
+            for (uint8_t attempt = 0; attempt < kMaxBacktracks && !improved; ++attempt, scale /= 2.0f)
+            {
+                RSSPose next = {
+                    pose.nx - delta[0] * scale,
+                    pose.ny - delta[1] * scale,
+                    std::clamp(pose.hz - delta[2] * scale, _minHeight, _maxHeight)
+                };
+                std::array<float, 3> nextResidual = error(kinematics, next, cosAngles, sinAngles);
+                if (worst(nextResidual) < result.residual)
+                {
+                    pose = next;
+                    residual = nextResidual;
+                    result.pose = pose;
+                    result.residual = worst(residual);
+                    improved = true;
+                }
+            }
+            if (!improved)
+            {
+                break;
+            }
+        }
+
+        result.converged = result.residual <= kTolerance;
+        return result;
+    }
+
+    // The closure error has a solution for every way the linkage can be
+    // assembled, only the one the inverse kinematics gives back is the neck
+    static bool matches(const RSSKinematics &kinematics, const RSSPose &pose, const std::array<float, 3> &angles)
+    {
+        float nmag = std::sqrt(pose.nx * pose.nx + pose.ny * pose.ny + 1.0f);
+        RSSKinematics::Solution solution = kinematics.solve(pose.nx / nmag, pose.ny / nmag, 1.0f / nmag, pose.hz);
+        for (size_t leg = 0; leg < angles.size(); ++leg)
+        {
+            if (std::fabs(solution.angles[leg] - angles[leg]) > kBranchTolerance)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    static std::array<float, 3> error(const RSSKinematics &kinematics, const RSSPose &pose,
+        const std::array<float, 3> &cosAngles, const std::array<float, 3> &sinAngles)
+    {
+        float nmag = std::sqrt(pose.nx * pose.nx + pose.ny * pose.ny + 1.0f);
+        return kinematics.closureError(pose.nx / nmag, pose.ny / nmag, 1.0f / nmag, pose.hz, cosAngles, sinAngles);
+    }
+
+    static float worst(const std::array<float, 3> &residual)
+    {
+        return std::max({std::fabs(residual[0]), std::fabs(residual[1]), std::fabs(residual[2])});
+    }
+
+    // Cramer's rule, false if the Jacobian is singular
+    static bool solve3x3(const float m[3][3], const std::array<float, 3> &b, float x[3])
+    {
+        const float c0 = m[1][1] * m[2][2] - m[1][2] * m[2][1];
+        const float c1 = m[1][2] * m[2][0] - m[1][0] * m[2][2];
+        const float c2 = m[1][0] * m[2][1] - m[1][1] * m[2][0];
+        const float determinant = m[0][0] * c0 + m[0][1] * c1 + m[0][2] * c2;
+        if (std::fabs(determinant) < 1e-9f)
+        {
+            return false;
+        }
+        const float inverse = 1.0f / determinant;
+        x[0] = (b[0] * c0
+            + m[0][1] * (m[1][2] * b[2] - b[1] * m[2][2])
+            + m[0][2] * (b[1] * m[2][1] - m[1][1] * b[2])) * inverse;
+        x[1] = (m[0][0] * (b[1] * m[2][2] - m[1][2] * b[2])
+            + b[0] * c1
+            + m[0][2] * (m[1][0] * b[2] - b[1] * m[2][0])) * inverse;
+        x[2] = (m[0][0] * (m[1][1] * b[2] - b[1] * m[2][1])
+            + m[0][1] * (b[1] * m[2][0] - m[1][0] * b[2])
+            + b[0] * c2) * inverse;
+        return true;
+    }
+
+    float _minHeight = 0.0f;
+    float _maxHeight = 0.0f;
+    RSSPose _lastPose = {0.0f, 0.0f, 0.0f};
+};
@@ -0,0 +1,162 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include "include/chopper/dome/RSSForwardKinematics.h"
+
+/*
+    Canned neck gestures for the RSS neck, each a short curve in pose space.
+
+    A gesture is an offset (nx, ny, hz) added to whatever pose the neck is
+    already in, so it plays on top of live joystick input.  Every curve is
+    shaped by an envelope that starts and ends at zero, so a gesture blends
+    in and out without a step.  Amplitude and speed scale the defaults below.
+
+        offset
+        |     /\      /\
+        |____/  \    /  \______ t
+        |        \  /
+        |         \/
+          |<-- duration -->|
+*/
+class RSSGesture
+{
+public:
+    enum class Type : uint8_t
+    {
+        None,
+        // down and up twice
+        Nod,
+        // lean to one side, hold, and come back
+        Tilt,
+        // one circle of the head
+        LookAround,
+        // small uneven wobble while rising a little
+        Curious
+    };
+
+    RSSGesture() = default;
+    ~RSSGesture() = default;
+
+    /*
+        Starts a gesture at startTime, once per button press.  A gesture
+        still playing is faded out over kBlendMs from the offset it had
+        reached, so switching gestures never steps the neck.  Returns true
+        if a gesture started.
+    */
+    bool start(Type type, uint64_t startTime, float amplitude = 1.0f, float speed = 1.0f)
+    {
+        if (type == Type::None)
+        {
+            return false;
+        }
+        _blendFrom = offset(startTime);
+        _type = type;
+        _startTime = startTime;
+        _amplitude = amplitude;
+        _duration = static_cast<uint32_t>(defaultDuration(type) / std::max(speed, 0.1f));
+        return true;
+    }
+
+    void stop()
+    {
+        _type = Type::None;
+    }
+
+    bool isActive(uint64_t currentTime) const
+    {
+        return _type != Type::None && currentTime < _startTime + _duration;
+    }
+
+    // Offset to add to the neck pose at currentTime, zero when nothing is playing
+    RSSPose offset(uint64_t currentTime) const
+    {
+        if (!isActive(currentTime) || currentTime < _startTime)
+        {
+            return {0.0f, 0.0f, 0.0f};
+        }
+        const uint64_t elapsed = currentTime - _startTime;
+        RSSPose pose = curve(static_cast<float>(elapsed) / _duration);
+        if (elapsed < kBlendMs)
+        {
+            // what is left of the gesture this one replaced
+            const float fade = 1.0f - smoothstep(static_cast<float>(elapsed) / kBlendMs);
+            pose.nx += _blendFrom.nx * fade;
+            pose.ny += _blendFrom.ny * fade;
+            pose.hz += _blendFrom.hz * fade;
+        }
+        return pose;
+    }
+
+private:
+    static constexpr float kPi = static_cast<float>(M_PI);
+    static constexpr float kTwoPi = static_cast<float>(2.0 * M_PI);
+
+    // time to fade out a gesture that another one replaced
+    static constexpr uint32_t kBlendMs = 250;
+
+    // default amplitudes, in tilt (normal vector) units and mm
+    static constexpr float kNodTilt = 0.12f;
+    static constexpr float kTiltTilt = 0.15f;
+    static constexpr float kLookAroundTilt = 0.15f;
+    static constexpr float kCuriousTilt = 0.06f;
+    static constexpr float kCuriousRise = 4.0f;
+
+    // Offset of the current gesture at t, its fraction [0, 1] of the duration
+    RSSPose curve(float t) const
+    {
+        const float envelope = std::sin(kPi * t);
+        const float a = _amplitude;
+        switch (_type)
+        {
+            case Type::Nod:
+                return {0.0f, -a * kNodTilt * envelope * std::sin(kTwoPi * 2.0f * t), 0.0f};
+            case Type::Tilt:
+            {
+                // eases over, holds for the middle half, eases back
+                const float lean = t < 0.25f ? smoothstep(t / 0.25f)
+                    : t > 0.75f ? smoothstep((1.0f - t) / 0.25f)
+                    : 1.0f;
+                return {a * kTiltTilt * lean, 0.0f, 0.0f};
+            }
+            case Type::LookAround:
+                return {
+                    a * kLookAroundTilt * envelope * std::cos(kTwoPi * t),
+                    a * kLookAroundTilt * envelope * std::sin(kTwoPi * t),
+                    0.0f
+                };
+            case Type::Curious:
+                return {
+                    a * kCuriousTilt * envelope * std::sin(kTwoPi * 3.0f * t),
+                    a * kCuriousTilt * 0.5f * envelope * std::sin(kTwoPi * 2.0f * t + 1.0f),
+                    a * kCuriousRise * envelope
+                };
+            default:
+                return {0.0f, 0.0f, 0.0f};
+        }
+    }
+
+    static uint32_t defaultDuration(Type type)
+    {
+        switch (type)
+        {
+            case Type::Nod: return 1200;
+            case Type::Tilt: return 2000;
+            case Type::LookAround: return 2500;
+            case Type::Curious: return 2000;
+            default: return 0;
+        }
+    }
+
+    static float smoothstep(float x)
+    {
+        return x * x * (3.0f - 2.0f * x);
+    }
+
+    Type _type = Type::None;
+    uint64_t _startTime = 0;
+    uint32_t _duration = 1;
+    float _amplitude = 1.0f;
+    RSSPose _blendFrom = {0.0f, 0.0f, 0.0f};
+};
@@ -0,0 +1,191 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+/*
+    Inverse kinematics kernel for the 3-RSS neck.
+
+    Pure single-precision math with no Arduino dependencies, so the same code
+    runs on the robot and on the host.  Everything that depends only on the
+    geometry is folded into constants once at construction, and the three
+    legs are written out rather than looped over.
+
+    The kernel does not limit its inputs or outputs.  When a pose is out of
+    reach the acos arguments are clamped, which resolves each leg to fully
+    stretched or folded, and isValid is cleared so the caller can decide
+    what to do with it.
+
+    See RSSMachine for the geometry (d, e, f, g) and the derivation of each leg.
+*/
+class RSSKinematics
+{
+public:
+    struct Solution
+    {
+        // leg angles in degrees: A, B, C
+        std::array<float, 3> angles;
+        // false if any leg could not reach the pose
+        bool isValid;
+    };
+
+    RSSKinematics(float d, float e, float f, float g, bool bendOut) :
+        _d(d),
+        _e(e),
+        _halfE(e / 2.0f),
+        _twoF(2.0f * f),
+        _linkDifference(f * f - g * g),
+        _legSign(bendOut ? 1.0f : -1.0f)
+    {
+    }
+
+    ~RSSKinematics() = default;
+
+    /*
+        nx, ny, nz must be a unit normal vector for the end-effector, hz its
+        height above the base.
+    */
+    Solution solve(float nx, float ny, float nz, float hz) const
+    {
+        const Corners corners = legCorners(nx, ny, nz, hz);
+        bool isValid = true;
+        Solution solution;
+        for (size_t leg = 0; leg < corners.size(); ++leg)
+        {
+            const float y = corners[leg][0];
+            const float z = corners[leg][1];
+            const float mag2 = y * y + z * z;
+            const float mag = std::sqrt(mag2);
+            solution.angles[leg] = legAngle(y / mag, mag2, mag, isValid);
+        }
+        solution.isValid = isValid;
+        return solution;
+    }
+
+    /*
+        solve() over arrays of poses, for sweeping many of them at once.
+        There are no branches in the loop body and none of the arrays may
+        overlap, so the compiler can vectorize it.  isValid is 1 where every
+        leg reached its pose.
+    */
+    void solveBatch(size_t count,
+        const float *__restrict nx, const float *__restrict ny, const float *__restrict nz, const float *__restrict hz,
+        float *__restrict angleA, float *__restrict angleB, float *__restrict angleC, uint8_t *__restrict isValid) const
+    {
+        // a local copy cannot alias the outputs, so the members stay in registers
+        const RSSKinematics kernel = *this;
+        for (size_t i = 0; i < count; ++i)
+        {
+            const Corners corners = kernel.legCorners(nx[i], ny[i], nz[i], hz[i]);
+            float angles[3];
+            uint8_t valid = 1;
+            for (size_t leg = 0; leg < 3; ++leg)
+            {
+                const float y = corners[leg][0];
+                const float z = corners[leg][1];
+                const float mag2 = y * y + z * z;
+                const float mag = std::sqrt(mag2);
+                const float cosTheta2 = (mag2 + kernel._linkDifference) / (kernel._twoF * mag);
+                valid &= static_cast<uint8_t>(std::fabs(cosTheta2) <= 1.0f);
+                angles[leg] = (std::acos(std::clamp(y / mag, -1.0f, 1.0f))
+                    + kernel._legSign * std::acos(std::clamp(cosTheta2, -1.0f, 1.0f))) * kRad2Deg;
+            }
+            angleA[i] = angles[0];
+            angleB[i] = angles[1];
+            angleC[i] = angles[2];
+            isValid[i] = valid;
+        }
+    }
+
+    /*
+        How far each leg is from closing its loop for the given pose and leg
+        angles (cos and sin of each, in radians): the distance from the knee
+        to the platform corner, less g, to first order, in the same units as 
+        the links.  Unlike the leg angles this stays smooth at full extension, 
+        so it is what forward kinematics solves against.
+    */
+    std::array<float, 3> closureError(
+        float nx, float ny, float nz, float hz,
+        const std::array<float, 3> &cosAngles, const std::array<float, 3> &sinAngles) const
+    {
+        const Corners corners = legCorners(nx, ny, nz, hz);
+        std::array<float, 3> error;
+        for (size_t leg = 0; leg < corners.size(); ++leg)
+        {
+            const float y = corners[leg][0];
+            const float z = corners[leg][1];
+            // |corner - knee|² - g² = mag² + f² - 2f(corner · knee direction) - g²
+            error[leg] = (y * y + z * z + _linkDifference) / _twoF - (y * cosAngles[leg] + z * sinAngles[leg]);
+        }
+        return error;
+    }
+
+private:
+    static constexpr float kSqrt3 = 1.7320508075688772f;
+    static constexpr float kSqrt3Over2 = kSqrt3 / 2.0f;
+    static constexpr float kTwoOverSqrt3 = 2.0f / kSqrt3;
+    static constexpr float kRad2Deg = static_cast<float>(180.0 / M_PI);
+
+    // Platform corner of each leg in the plane of that leg: distance along the
+    // leg's direction from its base joint, and height
+    using Corners = std::array<std::array<float, 2>, 3>;
+
+    Corners legCorners(float nx, float ny, float nz, float hz) const
+    {
+        const float nx2 = nx * nx;
+        const float ny2 = ny * ny;
+        const float nz1 = nz + 1.0f;
+        const float nxny = kSqrt3 * nx * ny;
+        Corners corners;
+
+        // Leg A
+        {
+            const float denominator = nz1 - nx2;
+            corners[0][0] = _d + _halfE * (
+                1.0f
+                - (nx2 + 3.0f * nz * nz + 3.0f * nz) / denominator
+                + (nx2 * nx2 - 3.0f * nx2 * ny2) / (nz1 * denominator));
+            corners[0][1] = _e * ny + hz;
+        }
+
+        // Leg B, y = x / √3 so x² + y² = 4x² / 3 and √3x + y = 4x / √3
+        {
+            const float x = kSqrt3Over2 * (_e * (1.0f - (nx2 + nxny) / nz1) - _d);
+            corners[1][0] = -kTwoOverSqrt3 * x;
+            corners[1][1] = hz - _halfE * (kSqrt3 * nx + ny);
+        }
+
+        // Leg C, y = -x / √3 so x² + y² = 4x² / 3 and √3x - y = 4x / √3
+        {
+            const float x = kSqrt3Over2 * (_d - _e * (1.0f - (nx2 - nxny) / nz1));
+            corners[2][0] = kTwoOverSqrt3 * x;
+            corners[2][1] = hz + _halfE * (kSqrt3 * nx - ny);
+        }
+
+        return corners;
+    }
+
+    float legAngle(float cosTheta1, float mag2, float mag, bool &isValid) const
+    {
+        // law of cosines
+        float cosTheta2 = (mag2 + _linkDifference) / (_twoF * mag);
+        if (cosTheta2 > 1.0f || cosTheta2 < -1.0f)
+        {
+            isValid = false;
+            cosTheta2 = std::clamp(cosTheta2, -1.0f, 1.0f);
+        }
+        // only rounding can push this one past ±1
+        cosTheta1 = std::clamp(cosTheta1, -1.0f, 1.0f);
+        return (std::acos(cosTheta1) + _legSign * std::acos(cosTheta2)) * kRad2Deg;
+    }
+
+    float _d;
+    float _e;
+    float _halfE;
+    float _twoF;
+    float _linkDifference;
+    float _legSign;
+};
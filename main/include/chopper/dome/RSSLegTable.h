@@ -0,0 +1,163 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <functional>
+#include "include/SettingsSystem.h"
+
+/*
+    Precomputed leg PWM for the RSS neck over a grid of joystick tilt (nx, ny)
+    for a set of evenly spaced height bands.
+
+    Built once at boot from the analytic inverse kinematics, then sampled per
+    frame with bilinear interpolation inside a height band and linear
+    interpolation between the two nearest bands.  Values are stored before 
+    the legs are limited to their reachable range, so the limit can be 
+    applied after interpolating without smearing its corner across a cell.  The interpolation
+    error against the analytic solution is sampled at the centre of every
+    cell while building, so the table can be checked against what the
+    servos can actually resolve.  It is an estimate, not an upper bound: 
+    near a leg's full extension the error can peak away from the centre.
+    tools/rss_kinematics measures the worst case on a dense grid.
+
+            ny
+       +R   .---.---.---.
+            |   | x |   |      x = cell centre used for the error estimate
+            .---.---.---.
+            |   |   |   |
+       -R   .---.---.---.  nx
+           -R          +R
+*/
+class RSSLegTable
+{
+public:
+    static constexpr uint8_t kGridSize = 11;
+    static constexpr uint8_t kHeightBands = 9;
+
+    // Leg PWM for a pose, in μs before rounding or limiting to the servo range
+    using Solver = std::function<std::array<float, 3>(float nx, float ny, float hz)>;
+
+    RSSLegTable() = default;
+    ~RSSLegTable() = default;
+
+    void build(const Solver &solve, float range, float minHeight, float maxHeight)
+    {
+        _range = range;
+        _minHeight = minHeight;
+        _gridStep = (2.0f * range) / (kGridSize - 1);
+        _heightStep = (maxHeight - minHeight) / (kHeightBands - 1);
+
+        for (uint8_t band = 0; band < kHeightBands; ++band)
+        {
+            float hz = minHeight + band * _heightStep;
+            for (uint8_t iy = 0; iy < kGridSize; ++iy)
+            {
+                float ny = -range + iy * _gridStep;
+                for (uint8_t ix = 0; ix < kGridSize; ++ix)
+                {
+                    float nx = -range + ix * _gridStep;
+                    std::array<float, 3> legs = solve(nx, ny, hz);
+                    for (size_t leg = 0; leg < legs.size(); ++leg)
+                    {
+                        _pwm[index(band, ix, iy)][leg] = static_cast<int16_t>(std::lround(legs[leg]));
+                    }
+                }
+            }
+        }
+        _isBuilt = true;
+
+        // sampled at the centre of each cell, halfway between bands
+        _maxError = 0.0f;
+        for (uint8_t band = 0; band < kHeightBands - 1; ++band)
+        {
+            float hz = minHeight + (band + 0.5f) * _heightStep;
+            for (uint8_t iy = 0; iy < kGridSize - 1; ++iy)
+            {
+                float ny = -range + (iy + 0.5f) * _gridStep;
+                for (uint8_t ix = 0; ix < kGridSize - 1; ++ix)
+                {
+                    float nx = -range + (ix + 0.5f) * _gridStep;
+                    std::array<float, 3> exact = solve(nx, ny, hz);
+                    std::array<float, 3> approx = interpolate(nx, ny, hz);
+                    for (size_t leg = 0; leg < exact.size(); ++leg)
+                    {
+                        _maxError = std::max(_maxError, std::fabs(exact[leg] - approx[leg]));
+                    }
+                }
+            }
+        }
+        DEBUG_RSS_MACHINE_PRINTF("RSSLegTable: %ux%u grid, %u bands, %u bytes, centre error: %4.2f us\n",
+            kGridSize, kGridSize, kHeightBands, static_cast<unsigned>(sizeof(_pwm)), _maxError);
+    }
+
+    // Call when anything the solver depends on changes
+    void invalidate()
+    {
+        _isBuilt = false;
+    }
+
+    bool isBuilt() const
+    {
+        return _isBuilt;
+    }
+
+    // Largest difference from the analytic solution at the cell centres, in μs.
+    // Sampled, so the error elsewhere in a cell can be larger.
+    float maxError() const
+    {
+        return _maxError;
+    }
+
+    std::array<float, 3> lookup(float nx, float ny, float hz) const
+    {
+        return interpolate(nx, ny, hz);
+    }
+
+private:
+    static constexpr size_t index(uint8_t band, uint8_t ix, uint8_t iy)
+    {
+        return (static_cast<size_t>(band) * kGridSize + iy) * kGridSize + ix;
+    }
+
+    // Splits a coordinate into the lower grid line and the fraction towards the next
+    static std::pair<uint8_t, float> locate(float value, float origin, float step, uint8_t count)
+    {
+        float position = std::clamp((value - origin) / step, 0.0f, static_cast<float>(count - 1));
+        uint8_t lower = std::min(static_cast<uint8_t>(position), static_cast<uint8_t>(count - 2));
+        return {lower, position - lower};
+    }
+
+    std::array<float, 3> interpolate(float nx, float ny, float hz) const
+    {
+        auto [ix, fx] = locate(nx, -_range, _gridStep, kGridSize);
+        auto [iy, fy] = locate(ny, -_range, _gridStep, kGridSize);
+        auto [band, fh] = locate(hz, _minHeight, _heightStep, kHeightBands);
+
+        std::array<float, 3> legs;
+        for (size_t leg = 0; leg < legs.size(); ++leg)
+        {
+            float value[2];
+            for (uint8_t b = 0; b < 2; ++b)
+            {
+                float p00 = _pwm[index(band + b, ix, iy)][leg];
+                float p10 = _pwm[index(band + b, ix + 1, iy)][leg];
+                float p01 = _pwm[index(band + b, ix, iy + 1)][leg];
+                float p11 = _pwm[index(band + b, ix + 1, iy + 1)][leg];
+                float bottom = p00 + (p10 - p00) * fx;
+                float top = p01 + (p11 - p01) * fx;
+                value[b] = bottom + (top - bottom) * fy;
+            }
+            legs[leg] = value[0] + (value[1] - value[0]) * fh;
+        }
+        return legs;
+    }
+
+    std::array<std::array<int16_t, 3>, kGridSize * kGridSize * kHeightBands> _pwm;
+    float _range = 0.0f;
+    float _minHeight = 0.0f;
+    float _gridStep = 1.0f;
+    float _heightStep = 1.0f;
+    float _maxError = 0.0f;
+    bool _isBuilt = false;
+};
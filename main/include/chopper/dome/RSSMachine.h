@@ -7,6 +7,9 @@
 #include <vector>
 #include <numeric>
 #include "include/SettingsSystem.h"
+#include "include/chopper/dome/RSSKinematics.h"
+#include "include/chopper/dome/RSSForwardKinematics.h"
+#include "include/chopper/dome/RSSWorkspace.h"
 
 class RSSMachine
 {
@@ -49,7 +52,8 @@ public:
         // minimum height of the end-effector from base as defined by the caller
         _platformMinHeight(min_height),
         _limitNormalVector(limit_normal_vector),
-        _jointIsBentOut(bend_out)
+        _jointIsBentOut(bend_out),
+        _kinematics(d, e, f, g, bend_out)
     {
         /*
             maximum height of the end-effector from base (before joint alternates)
@@ -83,6 +87,7 @@ public:
         _platformMaxHeight = std::sqrt(std::pow(g + f, 2) - std::pow(d - e, 2));
         _platformMaxHeightAngle = calculateStraightAngle();
         _platformMinHeightAngle = calculateMinHeightAngle();
+        _forwardKinematics.setHeightLimits(_platformMinHeight, _platformMaxHeight);
     }
 
     ~RSSMachine() = default;
@@ -339,11 +344,8 @@ public:
             This is useful because normalized vectors retain their direction but are easier to work with mathematically.
             To normalize a vector v with components (nx, ny, nz), you divide each component by the vector's magnitude
         */
-        float nmag = std::sqrt(std::pow(nx, 2.0f) + std::pow(ny, 2.0f) + 1.0f);
-        nx /= nmag;
-        ny /= nmag;
-        float nz = 1.0f / nmag;
-
+        float nz = 0.0f;
+        std::tie(nx, ny, nz) = normalize(nx, ny);
         return {
             std::clamp(nx, -_limitNormalVector, _limitNormalVector),
             std::clamp(ny, -_limitNormalVector, _limitNormalVector),
@@ -351,111 +353,110 @@ public:
         };
     }
 
-    std::array<float, 3> getLegAngles(float nx, float ny, float hz)
+    /*
+        Maps the reachable workspace once, so requests can be projected onto 
+        it instead of limiting each leg on its own.  Depends only on the 
+        geometry and the tilt limit.
+    */
+    void buildWorkspace()
     {
-        float nmag = 0.0f;      // magnitude
-        float nz = 0.0f;        // z component of the normal vector
-        float x = 0.0f;
-        float y = 0.0f;
-        float z = 0.0f;         // generic variables for the components of leg
-        float mag = 0.0f;       // generic magnitude of the leg vector
-        float theta1 = 0.0f;    // generic angle for triangle 1
-        float theta2 = 0.0f;    // generic theta for triangle 2
-
-        std::tie(nx, ny, nz) = unitNormalVector(nx, ny);
-        hz = std::clamp(hz, _platformMinHeight, _platformMaxHeight);
-        DEBUG_RSS_MACHINE_PRINTF("getLegAngles: nx: %4.2f ny: %4.2f hz: %4.2f\n", nx, ny, hz);
+        float lowAngle = std::min(_platformMinHeightAngle, _platformMaxHeightAngle);
+        float highAngle = std::max(_platformMinHeightAngle, _platformMaxHeightAngle);
+        // leaves room for rounding at the ends of the height range, where the legs sit on their limits
+        constexpr float tolerance = 0.01f;
+        _workspace.build(
+            [this, lowAngle, highAngle](float nx, float ny, float hz) {
+                float nz = 0.0f;
+                std::tie(nx, ny, nz) = normalize(nx, ny);
+                if (std::fabs(nx) > _limitNormalVector || std::fabs(ny) > _limitNormalVector)
+                {
+                    return false;
+                }
+                RSSKinematics::Solution solution = _kinematics.solve(nx, ny, nz, hz);
+                if (!solution.isValid)
+                {
+                    return false;
+                }
+                for (float angle : solution.angles)
+                {
+                    if (angle < lowAngle - tolerance || angle > highAngle + tolerance)
+                    {
+                        return false;
+                    }
+                }
+                return true;
+            },
+            // joystick is scaled to +/- the normal vector limit on each axis
+            _limitNormalVector * static_cast<float>(M_SQRT2),
+            _platformMinHeight,
+            _platformMaxHeight);
+    }
 
-        std::array<float, 3> leg_angles({0.0f, 0.0f, 0.0f});
-        for (int i = 0; i < 3; ++i)
+    // Scales a joystick tilt back along its direction until every leg can reach it
+    std::pair<float, float> projectToWorkspace(float nx, float ny, float hz) const
+    {
+        if (!_workspace.isBuilt())
         {
-            if (i == 0) 
-            {
-                // Leg A
-                x = 0.0f;
-                y = d + (e / 2) * (
-                    1 - (
-                        std::pow(nx, 2) + 3 * std::pow(nz, 2) + 3 * nz
-                    ) / (
-                        nz + 1 - std::pow(nx, 2)
-                    ) + (
-                        std::pow(nx, 4) - 3 * std::pow(nx, 2) * std::pow(ny, 2)
-                    ) / (
-                        (nz + 1) * (nz + 1 - std::pow(nx, 2))
-                    )
-                );
-                z = hz + e * ny;
-                // pythagorean theorem
-                mag = std::sqrt(std::pow(y, 2) + std::pow(z, 2));
-                theta1 = std::acos(y / mag);
-                // law of cosines
-                theta2 = std::acos(
-                    (std::pow(mag, 2) + std::pow(f, 2) - std::pow(g, 2)) / (2 * mag * f)
-                );
-            }
-            else if (i == 1)
-            {
-                // Leg B
-                x = (std::sqrt(3) / 2) * (
-                    e * (
-                        1 - (std::pow(nx, 2) + std::sqrt(3) * nx * ny) / (nz + 1)
-                    ) - d
-                );
-                y = x / std::sqrt(3);
-                z = hz - (e / 2) * (std::sqrt(3) * nx + ny);
-                // pythagorean theorem
-                mag = std::sqrt(std::pow(x, 2) + std::pow(y, 2) + std::pow(z, 2));
-                theta1 = std::acos(
-                    (std::sqrt(3) * x + y) / (-2 * mag)
-                );
-                // law of cosines
-                theta2 = std::acos(
-                    (std::pow(mag, 2) + std::pow(f, 2) - std::pow(g, 2)) / (2 * mag * f)
-                );
-            }
-            else if (i == 2)
-            {
-                // Leg C
-                x = (std::sqrt(3) / 2) * (
-                    d - e * (
-                        1 - (std::pow(nx, 2) - std::sqrt(3) * nx * ny) / (nz + 1)
-                    )
-                );
-                y = -x / std::sqrt(3);
-                z = hz + (e / 2) * (std::sqrt(3) * nx - ny);
-                // pythagorean theorem
-                mag = std::sqrt(std::pow(x, 2) + std::pow(y, 2) + std::pow(z, 2));
-                theta1 = std::acos(
-                    (std::sqrt(3) * x - y) / (2 * mag)
-                );
-                // law of cosines
-                theta2 = std::acos(
-                    (std::pow(mag, 2) + std::pow(f, 2) - std::pow(g, 2)) / (2 * mag * f)
-                );
-            }
+            return {nx, ny};
+        }
+        return _workspace.project(nx, ny, std::clamp(hz, _platformMinHeight, _platformMaxHeight));
+    }
 
-            if (_jointIsBentOut)
-            {
-                // when bending out:
-                //   _min_height_angle is the max angle
-                //   _max_height_angle is the min angle
-                leg_angles[i] = std::min(
-                    _platformMinHeightAngle, 
-                    std::max(_platformMaxHeightAngle, (theta1 + theta2) * _rad2deg));
-            }
-            else
-            {
-                // when bending in:
-                //   _min_height_angle is the min angle
-                //   _max_height_angle is the max angle
-                leg_angles[i] = std::min(
-                    _platformMaxHeightAngle, 
-                    std::max(_platformMinHeightAngle, (theta1 - theta2) * _rad2deg));
-            }
+    std::array<float, 3> getLegAngles(float nx, float ny, float hz)
+    {
+        std::tie(nx, ny) = projectToWorkspace(nx, ny, hz);
+        std::array<float, 3> leg_angles = solveLegAngles(nx, ny, hz);
+        for (float &angle : leg_angles)
+        {
+            angle = clampLegAngle(angle);
         }
         return leg_angles;
     }
+
+    /*
+        Platform pose that puts the legs at the given angles, in degrees.
+        Warm-starts from the last pose found, so call it with angles that 
+        follow on from each other.
+    */
+    RSSForwardKinematics::Result getPose(const std::array<float, 3> &legAngles)
+    {
+        return _forwardKinematics.solve(_kinematics, legAngles);
+    }
+
+    // Limits a leg angle to the range the machine can physically reach
+    float clampLegAngle(float angle) const
+    {
+        if (_jointIsBentOut)
+        {
+            // when bending out:
+            //   _min_height_angle is the max angle
+            //   _max_height_angle is the min angle
+            return std::min(_platformMinHeightAngle, std::max(_platformMaxHeightAngle, angle));
+        }
+        // when bending in:
+        //   _min_height_angle is the min angle
+        //   _max_height_angle is the max angle
+        return std::min(_platformMaxHeightAngle, std::max(_platformMinHeightAngle, angle));
+    }
+
+    // Normalizes (nx, ny, 1) without limiting the tilt
+    static std::tuple<float, float, float> normalize(float nx, float ny)
+    {
+        float nmag = std::sqrt(nx * nx + ny * ny + 1.0f);
+        return {nx / nmag, ny / nmag, 1.0f / nmag};
+    }
+
 protected:
+    // Leg angles in degrees before they are limited to the reachable range
+    std::array<float, 3> solveLegAngles(float nx, float ny, float hz)
+    {
+        float nz = 0.0f;        // z component of the normal vector
+        std::tie(nx, ny, nz) = unitNormalVector(nx, ny);
+        hz = std::clamp(hz, _platformMinHeight, _platformMaxHeight);
+        DEBUG_RSS_MACHINE_PRINTF("getLegAngles: nx: %4.2f ny: %4.2f hz: %4.2f\n", nx, ny, hz);
+        return _kinematics.solve(nx, ny, nz, hz).angles;
+    }
+
     float _limitNormalVector;
     float _platformMaxHeightAngle;
     float _platformMinHeightAngle;
@@ -467,4 +468,7 @@ private:
     const float _90degRad = 90.0f * M_PI / 180.0f;
     float d, e, f, g;
     bool _jointIsBentOut;
+    RSSKinematics _kinematics;
+    RSSForwardKinematics _forwardKinematics;
+    RSSWorkspace _workspace;
 };
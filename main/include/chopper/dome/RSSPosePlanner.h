@@ -0,0 +1,146 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include "include/chopper/dome/RSSForwardKinematics.h"
+
+/*
+    Moves the RSS neck through pose space (nx, ny, hz) towards a target pose,
+    limiting the velocity and acceleration of each axis on its own.
+
+    The motion is integrated in fixed ticks regardless of how often update()
+    is called, so it plays out the same whether the main loop runs fast or
+    stalls for a frame.  Each axis accelerates towards its target, cruises at
+    its velocity limit and brakes so it arrives with no overshoot:
+
+        v
+        |    ________
+        |   /        \
+        |  /          \
+        | /            \
+        |/______________\___ t
+          amax   vmax   amax
+*/
+class RSSPosePlanner
+{
+public:
+    struct Limits
+    {
+        // tilt per second and per second²
+        float tiltVelocity;
+        float tiltAcceleration;
+        // height units per second and per second²
+        float heightVelocity;
+        float heightAcceleration;
+    };
+
+    RSSPosePlanner(const Limits &limits, uint32_t tickMs) :
+        _limits(limits),
+        _tickMs(std::max<uint32_t>(tickMs, 1)),
+        _tick(_tickMs / 1000.0f)
+    {
+    }
+
+    ~RSSPosePlanner() = default;
+
+    // Jumps straight to a pose, e.g. one estimated from the legs
+    void reset(const RSSPose &pose, uint64_t currentTime)
+    {
+        _axes[0] = {pose.nx, 0.0f, pose.nx};
+        _axes[1] = {pose.ny, 0.0f, pose.ny};
+        _axes[2] = {pose.hz, 0.0f, pose.hz};
+        _lastTime = currentTime;
+        _isStarted = true;
+    }
+
+    void setTarget(const RSSPose &pose)
+    {
+        _axes[0].target = pose.nx;
+        _axes[1].target = pose.ny;
+        _axes[2].target = pose.hz;
+    }
+
+    RSSPose target() const
+    {
+        return {_axes[0].target, _axes[1].target, _axes[2].target};
+    }
+
+    RSSPose pose() const
+    {
+        return {_axes[0].position, _axes[1].position, _axes[2].position};
+    }
+
+    bool isStarted() const
+    {
+        return _isStarted;
+    }
+
+    // True once every axis has reached its target and stopped
+    bool isSettled() const
+    {
+        for (const Axis &axis : _axes)
+        {
+            if (axis.position != axis.target || axis.velocity != 0.0f)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Advances in whole ticks up to currentTime and returns the pose
+    RSSPose update(uint64_t currentTime)
+    {
+        if (currentTime < _lastTime)
+        {
+            _lastTime = currentTime;
+        }
+        uint64_t ticks = (currentTime - _lastTime) / _tickMs;
+        _lastTime += ticks * _tickMs;
+        // after a long stall carry on from where it was instead of catching up
+        ticks = std::min<uint64_t>(ticks, kMaxCatchUpTicks);
+        for (uint64_t i = 0; i < ticks; ++i)
+        {
+            step(_axes[0], _limits.tiltVelocity, _limits.tiltAcceleration);
+            step(_axes[1], _limits.tiltVelocity, _limits.tiltAcceleration);
+            step(_axes[2], _limits.heightVelocity, _limits.heightAcceleration);
+        }
+        return pose();
+    }
+
+private:
+    static constexpr uint8_t kMaxCatchUpTicks = 10;
+
+    struct Axis
+    {
+        float position;
+        float velocity;
+        float target;
+    };
+
+    void step(Axis &axis, float maxVelocity, float maxAcceleration) const
+    {
+        float error = axis.target - axis.position;
+        float maxChange = maxAcceleration * _tick;
+        if (std::fabs(error) <= maxChange * _tick && std::fabs(axis.velocity) <= maxChange)
+        {
+            // close enough to stop within a tick
+            axis.position = axis.target;
+            axis.velocity = 0.0f;
+            return;
+        }
+        // fastest speed that can still brake to a stop at the target
+        float brakingVelocity = std::sqrt(2.0f * maxAcceleration * std::fabs(error));
+        float desired = std::copysign(std::min(maxVelocity, brakingVelocity), error);
+        axis.velocity += std::clamp(desired - axis.velocity, -maxChange, maxChange);
+        axis.position += axis.velocity * _tick;
+    }
+
+    Limits _limits;
+    uint32_t _tickMs;
+    float _tick;
+    Axis _axes[3] = {};
+    uint64_t _lastTime = 0;
+    bool _isStarted = false;
+};
@@ -0,0 +1,244 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <functional>
+#include <utility>
+#include "include/SettingsSystem.h"
+
+/*
+    Reachable workspace of the RSS neck in joystick tilt (nx, ny) for a set
+    of evenly spaced height bands.
+
+    For every band and direction the largest reachable tilt is found once at
+    boot by bisecting along the ray from level (0, 0), which is always
+    reachable.  A request is then projected onto the reachable set in O(1):
+    the limit for its direction is interpolated from the two nearest
+    directions and the two nearest bands, and the request is scaled back
+    along its own direction if it is beyond it.  Scaling keeps the direction
+    the joystick asked for, so all three legs agree on a single pose instead
+    of each leg being clamped on its own.
+
+    The boundary is searched in pose space against the inverse kinematics
+    rather than traced from the forward kinematics.  Both describe the same
+    set: a pose is reachable exactly when the IK finds every leg and puts it
+    inside its limits, which is the forward image of the leg limits on the
+    neck's own branch of the linkage.  Bisecting the IK answers that along
+    each ray directly, in a few thousand closed-form solves.  Building it
+    from RSSForwardKinematics would mean sweeping the box of leg angles
+    with a Newton solve for each sample, then binning the scattered poses
+    by direction, which costs far more at boot and leaves a ragged edge
+    wherever the sweep was sparse.
+
+    Directions are indexed by a "diamond angle" in [0, 4), which is monotonic
+    with the real angle and needs no trig per frame.
+
+               1
+               .
+             /   \
+         2  .  +  .  0 / 4
+             \   /
+               .
+               3
+*/
+class RSSWorkspace
+{
+public:
+    static constexpr uint8_t kDirections = 32;
+    static constexpr uint8_t kHeightBands = 9;
+
+    // True when the pose can be reached with every leg inside its limits
+    using Reachable = std::function<bool(float nx, float ny, float hz)>;
+
+    RSSWorkspace() = default;
+    ~RSSWorkspace() = default;
+
+    void build(const Reachable &isReachable, float searchRadius, float minHeight, float maxHeight)
+    {
+        _minHeight = minHeight;
+        _heightStep = (maxHeight - minHeight) / (kHeightBands - 1);
+
+        for (uint8_t band = 0; band < kHeightBands; ++band)
+        {
+            float hz = minHeight + band * _heightStep;
+            for (uint8_t direction = 0; direction < kDirections; ++direction)
+            {
+                auto [ux, uy] = unitFromDiamond(direction * (4.0f / kDirections));
+                float reachable = 0.0f;
+                float unreachable = searchRadius;
+                if (isReachable(ux * searchRadius, uy * searchRadius, hz))
+                {
+                    reachable = searchRadius;
+                }
+                else
+                {
+                    for (uint8_t i = 0; i < kBisections; ++i)
+                    {
+                        float radius = (reachable + unreachable) / 2.0f;
+                        if (isReachable(ux * radius, uy * radius, hz))
+                        {
+                            reachable = radius;
+                        }
+                        else
+                        {
+                            unreachable = radius;
+                        }
+                    }
+                }
+                _radius[band][direction] = reachable;
+            }
+        }
+        _isBuilt = true;
+
+        [[maybe_unused]] uint8_t passes = tighten(isReachable);
+        DEBUG_RSS_MACHINE_PRINTF("RSSWorkspace: %u directions, %u bands, %u bytes, tightened in %u passes\n",
+            kDirections, kHeightBands, static_cast<unsigned>(sizeof(_radius)), passes);
+    }
+
+    void invalidate()
+    {
+        _isBuilt = false;
+    }
+
+    bool isBuilt() const
+    {
+        return _isBuilt;
+    }
+
+    // Largest reachable tilt in the direction of (nx, ny) at height hz
+    float limit(float nx, float ny, float hz) const
+    {
+        float position = std::clamp((hz - _minHeight) / _heightStep, 0.0f, static_cast<float>(kHeightBands - 1));
+        uint8_t band = std::min(static_cast<uint8_t>(position), static_cast<uint8_t>(kHeightBands - 2));
+        float fh = position - band;
+
+        float angle = diamondAngle(nx, ny) * (kDirections / 4.0f);
+        uint8_t direction = static_cast<uint8_t>(angle) % kDirections;
+        uint8_t next = (direction + 1) % kDirections;
+        float fd = angle - std::floor(angle);
+
+        float lower = _radius[band][direction] + (_radius[band][next] - _radius[band][direction]) * fd;
+        float upper = _radius[band + 1][direction] + (_radius[band + 1][next] - _radius[band + 1][direction]) * fd;
+        return lower + (upper - lower) * fh;
+    }
+
+    // Scales (nx, ny) back along its direction onto the reachable set at height hz
+    std::pair<float, float> project(float nx, float ny, float hz) const
+    {
+        float radius2 = nx * nx + ny * ny;
+        if (radius2 == 0.0f)
+        {
+            return {nx, ny};
+        }
+        float maxRadius = limit(nx, ny, hz);
+        if (radius2 <= maxRadius * maxRadius)
+        {
+            return {nx, ny};
+        }
+        float scale = maxRadius / std::sqrt(radius2);
+        return {nx * scale, ny * scale};
+    }
+
+private:
+    // ~0.0002 of tilt with the default search radius
+    static constexpr uint8_t kBisections = 12;
+
+    static constexpr uint8_t kMaxTightenPasses = 32;
+    static constexpr float kTightenFactor = 0.98f;
+
+    /*
+        The boundary is exact only at the samples.  Between them the 
+        interpolated limit can cut a little past it, and near full leg
+        extension a small overshoot in tilt is a large step in leg angle.
+        Checks points inside every cell and pulls in the corners of any 
+        cell that overshoots until none do, so a projected pose is always 
+        reachable.
+    */
+    uint8_t tighten(const Reachable &isReachable)
+    {
+        static constexpr float fractions[] = {0.25f, 0.5f, 0.75f};
+        for (uint8_t pass = 1; pass <= kMaxTightenPasses; ++pass)
+        {
+            bool tightened = false;
+            for (uint8_t band = 0; band < kHeightBands - 1; ++band)
+            {
+                for (uint8_t direction = 0; direction < kDirections; ++direction)
+                {
+                    uint8_t next = (direction + 1) % kDirections;
+                    bool overshoots = false;
+                    for (float fh : fractions)
+                    {
+                        float hz = _minHeight + (band + fh) * _heightStep;
+                        for (float fd : fractions)
+                        {
+                            auto [ux, uy] = unitFromDiamond((direction + fd) * (4.0f / kDirections));
+                            float radius = limit(ux, uy, hz);
+                            if (!isReachable(ux * radius, uy * radius, hz))
+                            {
+                                overshoots = true;
+                            }
+                        }
+                    }
+                    if (overshoots)
+                    {
+                        _radius[band][direction] *= kTightenFactor;
+                        _radius[band][next] *= kTightenFactor;
+                        _radius[band + 1][direction] *= kTightenFactor;
+                        _radius[band + 1][next] *= kTightenFactor;
+                        tightened = true;
+                    }
+                }
+            }
+            if (!tightened)
+            {
+                return pass;
+            }
+        }
+        return kMaxTightenPasses;
+    }
+
+    // Maps a direction to [0, 4) without trig, counter-clockwise from +x
+    static float diamondAngle(float x, float y)
+    {
+        float sum = std::fabs(x) + std::fabs(y);
+        if (y >= 0.0f)
+        {
+            return x >= 0.0f ? y / sum : 1.0f - x / sum;
+        }
+        return x < 0.0f ? 2.0f - y / sum : 3.0f + x / sum;
+    }
+
+    // Inverse of diamondAngle(), as a unit vector
+    static std::pair<float, float> unitFromDiamond(float angle)
+    {
+        float x, y;
+        if (angle < 1.0f)
+        {
+            x = 1.0f - angle;
+            y = angle;
+        }
+        else if (angle < 2.0f)
+        {
+            x = 1.0f - angle;
+            y = 2.0f - angle;
+        }
+        else if (angle < 3.0f)
+        {
+            x = angle - 3.0f;
+            y = 2.0f - angle;
+        }
+        else
+        {
+            x = angle - 3.0f;
+            y = angle - 4.0f;
+        }
+        float magnitude = std::sqrt(x * x + y * y);
+        return {x / magnitude, y / magnitude};
+    }
+
+    std::array<std::array<float, kDirections>, kHeightBands> _radius = {};
+    float _minHeight = 0.0f;
+    float _heightStep = 1.0f;
+    bool _isBuilt = false;
+};
@@ -4,6 +4,8 @@
 
 #pragma once
 
+#include <algorithm>
+#include <cmath>
 #include <functional>
 #include <string>
 
@@ -100,13 +102,29 @@ class DifferentialDrive : public RobotDriveBase
   DifferentialDrive(std::function<void(float)> leftMotor,
                     std::function<void(float)> rightMotor);
 
+  /**
+   * Construct a DifferentialDrive that sets both sides in one call.
+   *
+   * For motor controllers that can update both sides at once, e.g. a
+   * Sabertooth in mixed mode.
+   *
+   * @param wheels Setter taking the left and right motor speeds.
+   */
+  explicit DifferentialDrive(std::function<void(float, float)> wheels);
+
   ~DifferentialDrive() override = default;
 
   DifferentialDrive(DifferentialDrive&&) = default;
   DifferentialDrive& operator=(DifferentialDrive&&) = default;
 
 
-  void ApplySpeedToMotors();
+  /**
+   * Stores the outputs and sends them to the wheels after the speed limit.
+   *
+   * @param leftOutput  Left wheel output [-1.0..1.0].
+   * @param rightOutput Right wheel output [-1.0..1.0].
+   */
+  void ApplySpeedToMotors(float leftOutput, float rightOutput);
 
   /**
    * Arcade drive method for differential drive platform.
@@ -178,8 +196,35 @@ class DifferentialDrive : public RobotDriveBase
    * @param squareInputs If set, decreases the input sensitivity at low speeds.
    * @return Wheel speeds [-1.0..1.0].
    */
-  static WheelSpeeds ArcadeDriveIK(float xSpeed, float zRotation,
-                                   bool squareInputs = true);
+  static constexpr WheelSpeeds ArcadeDriveIK(float xSpeed, float zRotation,
+                                             bool squareInputs = true)
+  {
+    xSpeed = std::clamp(xSpeed, -1.0f, 1.0f);
+    zRotation = std::clamp(zRotation, -1.0f, 1.0f);
+
+    // Square the inputs (while preserving the sign) to increase fine control
+    // while permitting full power.
+    if (squareInputs) {
+      xSpeed = std::copysign(xSpeed * xSpeed, xSpeed);
+      zRotation = std::copysign(zRotation * zRotation, zRotation);
+    }
+
+    float leftSpeed = xSpeed - zRotation;
+    float rightSpeed = xSpeed + zRotation;
+
+    // Find the maximum possible value of (throttle + turn) along the vector
+    // that the joystick is pointing, then desaturate the wheel speeds
+    float greaterInput = (std::max)(std::abs(xSpeed), std::abs(zRotation));
+    float lesserInput = (std::min)(std::abs(xSpeed), std::abs(zRotation));
+    if (greaterInput == 0.0f) {
+      return {0.0f, 0.0f};
+    }
+    float saturatedInput = (greaterInput + lesserInput) / greaterInput;
+    leftSpeed /= saturatedInput;
+    rightSpeed /= saturatedInput;
+
+    return {leftSpeed, rightSpeed};
+  }
 
   /**
    * Curvature drive inverse kinematics for differential drive platform.
@@ -197,11 +242,78 @@ class DifferentialDrive : public RobotDriveBase
    *                         turning rate instead of curvature.
    * @return Wheel speeds [-1.0..1.0].
    */
-  static WheelSpeeds CurvatureDriveIK(float xSpeed, float zRotation,
-                                      bool allowTurnInPlace);
+  static constexpr WheelSpeeds CurvatureDriveIK(float xSpeed, float zRotation,
+                                                bool allowTurnInPlace)
+  {
+    xSpeed = std::clamp(xSpeed, -1.0f, 1.0f);
+    zRotation = std::clamp(zRotation, -1.0f, 1.0f);
+
+    float leftSpeed = 0.0f;
+    float rightSpeed = 0.0f;
+
+    // TODO: when at very small values just outside deadzone, this can cause creap b/c it's not squared
+    if (allowTurnInPlace) {
+      leftSpeed = xSpeed - zRotation;
+      rightSpeed = xSpeed + zRotation;
+    } else {
+      leftSpeed = xSpeed - std::abs(xSpeed) * zRotation;
+      rightSpeed = xSpeed + std::abs(xSpeed) * zRotation;
+    }
+
+    // Desaturate wheel speeds
+    float maxMagnitude = (std::max)(std::abs(leftSpeed), std::abs(rightSpeed));
+    if (maxMagnitude > 1.0f) {
+      leftSpeed /= maxMagnitude;
+      rightSpeed /= maxMagnitude;
+    }
+
+    return {leftSpeed, rightSpeed};
+  }
+
+  /**
+   * ReelTwo drive inverse kinematics for differential drive platform.
+   *
+   * The stick vector is rotated by 45 degrees so its axes line up with the
+   * left and right wheels, then scaled by √2 so the cardinal directions still
+   * reach full speed:
+   *
+   *   left  = √2·r·cos(θ + π/4) = x - z
+   *   right = √2·r·sin(θ + π/4) = x + z
+   *
+   * The scaling overshoots near the diagonals, so the wheel speeds are
+   * desaturated back into [-1.0..1.0] while keeping their ratio.
+   *
+   * @param xSpeed       The robot's speed along the X axis [-1.0..1.0].
+   *                     Forward is positive.
+   * @param zRotation    The rotation rate of the robot around the Z axis
+   *                     [-1.0..1.0]. Clockwise is positive.
+   * @param squareInputs If set, decreases the input sensitivity at low speeds.
+   * @return Wheel speeds [-1.0..1.0].
+   */
+  static constexpr WheelSpeeds ReelTwoDriveIK(float xSpeed, float zRotation,
+                                              bool squareInputs)
+  {
+    xSpeed = std::clamp(xSpeed, -1.0f, 1.0f);
+    zRotation = std::clamp(zRotation, -1.0f, 1.0f);
+
+    // Square the inputs (while preserving the sign) to increase fine control
+    // while permitting full power.
+    if (squareInputs) {
+      xSpeed = std::copysign(xSpeed * xSpeed, xSpeed);
+      zRotation = std::copysign(zRotation * zRotation, zRotation);
+    }
+
+    float leftSpeed = xSpeed - zRotation;
+    float rightSpeed = xSpeed + zRotation;
 
-  static WheelSpeeds ReelTwoDriveIK(float xSpeed, float zRotation,
-                                      bool squareInputs);
+    float maxMagnitude = (std::max)(std::abs(leftSpeed), std::abs(rightSpeed));
+    if (maxMagnitude > 1.0f) {
+      leftSpeed /= maxMagnitude;
+      rightSpeed /= maxMagnitude;
+    }
+
+    return {leftSpeed, rightSpeed};
+  }
 
   /**
    * Tank drive inverse kinematics for differential drive platform.
@@ -213,17 +325,30 @@ class DifferentialDrive : public RobotDriveBase
    * @param squareInputs If set, decreases the input sensitivity at low speeds.
    * @return Wheel speeds [-1.0..1.0].
    */
-  static WheelSpeeds TankDriveIK(float leftSpeed, float rightSpeed,
-                                 bool squareInputs = true);
+  static constexpr WheelSpeeds TankDriveIK(float leftSpeed, float rightSpeed,
+                                           bool squareInputs = true)
+  {
+    leftSpeed = std::clamp(leftSpeed, -1.0f, 1.0f);
+    rightSpeed = std::clamp(rightSpeed, -1.0f, 1.0f);
+
+    // Square the inputs (while preserving the sign) to increase fine control
+    // while permitting full power.
+    if (squareInputs) {
+      leftSpeed = std::copysign(leftSpeed * leftSpeed, leftSpeed);
+      rightSpeed = std::copysign(rightSpeed * rightSpeed, rightSpeed);
+    }
+
+    return {leftSpeed, rightSpeed};
+  }
 
   void StopMotor() override;
+  void RampMotor(float scale) override;
   std::string GetDescription() const override;
 
   // void InitSendable(wpi::SendableBuilder& builder) override;
 
  private:
-  std::function<void(float)> m_leftMotor;
-  std::function<void(float)> m_rightMotor;
+  std::function<void(float, float)> m_wheels;
 
   // Used for Sendable property getters
   float m_leftOutput = 0.0f;
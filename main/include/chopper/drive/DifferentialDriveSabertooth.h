@@ -1,30 +1,36 @@
 #pragma once
 
 #include "chopper/drive/DifferentialDrive.h"
-#include "chopper/motorController/SabertoothController.h"
+#include "chopper/drive/SabertoothDrive.h"
 #include <Sabertooth.h>
 #include <Bluepad32.h>
 #include "SettingsSystem.h"
 
+/**
+ * A DifferentialDrive on both motors of one Sabertooth, which also programs
+ * the Sabertooth's own ramping and serial timeout.
+ */
 class DifferentialDriveSabertooth : public DifferentialDrive
 { 
  public:
-  // static DifferentialDriveSabertooth create(int sabertoothId, Stream& serial, int leftMotorId = 1, int rightMotorId = 2)
-  // {
-  //   m_sabertoothDriver = Sabertooth((byte)sabertoothId, serial);
-  //   m_sabertoothDriver.setBaudRate(9600);
-  //   m_leftMotor = SabertoothController(m_sabertoothDriver, leftMotorId);
-  //   m_rightMotor = SabertoothController(m_sabertoothDriver, rightMotorId);
-  //   return DifferentialDriveSabertooth(m_leftMotor, m_rightMotor);
-  // }
+  explicit DifferentialDriveSabertooth(SabertoothDrive& sabertoothDrive);
+
+  /**
+   * Sets the ramping and programs it into the Sabertooth.
+   */
   void SetRampingValue(int ramping);
   void SetDeadband(float deadband);
   void SetExpiration(uint64_t expirationTime);
 
+  /**
+   * Programs the Sabertooth to stop the motors by itself when no command
+   * arrives for this long.  A backstop for when the firmware hangs, so it
+   * should be longer than the expiration, which stops the motors first.
+   *
+   * @param timeoutMs Timeout, rounded up to 100 ms.  0 disables it.
+   */
+  void SetSerialTimeout(uint64_t timeoutMs);
+
  protected:
-  // static Sabertooth m_sabertoothDriver;
-  // static SabertoothController m_leftMotor;
-  // static SabertoothController m_rightMotor;
-  // DifferentialDriveSabertooth(MotorController& leftMotor, MotorController& rightMotor) : 
-  //   DifferentialDrive(leftMotor, rightMotor) {}
+  SabertoothDrive& m_sabertoothDrive;
 };
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdlib>
+#include <cstdint>
+#include <utility>
+
+/**
+ * Wheel commands for one drive mode, precomputed for every stick position the
+ * motor controller can tell apart.
+ *
+ * The Sabertooth only takes 127 steps each way, so the stick is quantized to
+ * the same steps and the wheel command is read straight out of a table built
+ * at compile time from the drive mode's inverse kinematics.  The table lives
+ * in flash and a lookup does no squaring, desaturating or trig.
+ *
+ * Only one quadrant is stored.  The arcade, curvature and ReelTwo relations
+ * are all mirror symmetric, so the other three quadrants are a swap and/or a
+ * negation of it:
+ *
+ *   f(x, -z) = (right, left)
+ *   f(-x, z) = (-right, -left)
+ *
+ * @tparam WheelSpeeds The {left, right} type the kernel returns.
+ */
+template <typename WheelSpeeds>
+class DriveIKTable
+{
+ public:
+  /// Steps each way, the Sabertooth's resolution.
+  static constexpr int kSteps = 127;
+
+  /**
+   * Builds the table from an inverse kinematics kernel.
+   *
+   * @param kernel Maps (xSpeed, zRotation) in [0.0..1.0] to WheelSpeeds.
+   */
+  template <typename Kernel>
+  constexpr explicit DriveIKTable(Kernel kernel) : m_commands{}
+  {
+    for (int x = 0; x <= kSteps; ++x) {
+      for (int z = 0; z <= kSteps; ++z) {
+        WheelSpeeds speeds = kernel(static_cast<float>(x) / kSteps,
+                                    static_cast<float>(z) / kSteps);
+        m_commands[x * (kSteps + 1) + z] = {Quantize(speeds.left),
+                                            Quantize(speeds.right)};
+      }
+    }
+  }
+
+  /**
+   * Wheel speeds for a stick position, rounded to the nearest step.
+   *
+   * @param xSpeed    [-1.0..1.0], clamped.
+   * @param zRotation [-1.0..1.0], clamped.
+   * @return Wheel speeds [-1.0..1.0] in whole steps.
+   */
+  WheelSpeeds Lookup(float xSpeed, float zRotation) const
+  {
+    int x = Quantize(xSpeed);
+    int z = Quantize(zRotation);
+    Command command = m_commands[std::abs(x) * (kSteps + 1) + std::abs(z)];
+    int left = command.left;
+    int right = command.right;
+    if (z < 0) {
+      std::swap(left, right);
+    }
+    if (x < 0) {
+      std::swap(left, right);
+      left = -left;
+      right = -right;
+    }
+    return {static_cast<float>(left) / kSteps, static_cast<float>(right) / kSteps};
+  }
+
+  /// Rounds [-1.0..1.0] to the nearest of the ±kSteps steps.
+  static constexpr int8_t Quantize(float value)
+  {
+    value = std::clamp(value, -1.0f, 1.0f) * kSteps;
+    return static_cast<int8_t>(value >= 0.0f ? value + 0.5f : value - 0.5f);
+  }
+
+ private:
+  struct Command
+  {
+    int8_t left;
+    int8_t right;
+  };
+
+  std::array<Command, (kSteps + 1) * (kSteps + 1)> m_commands;
+};
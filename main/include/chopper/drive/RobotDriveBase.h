@@ -8,6 +8,8 @@
 // #include <span>
 #include <string>
 
+#include <wpi/mutex.h>
+
 #include "chopper/MotorSafety.h"
 
 /**
@@ -128,6 +130,10 @@ class RobotDriveBase : public MotorSafety
    */
   // static void Desaturate(std::span<float> wheelSpeeds);
 
+  /// Held while the outputs are set or read, the watchdog thread ramps them
+  /// down through RampMotor() while the main loop may be driving.
+  wpi::mutex m_outputMutex;
+
   /// Input ramping.
   float m_rampingValue = kDefaultRampingValue;
 
@@ -1,9 +1,12 @@
 #pragma once
 
 #include "chopper/motorController/SabertoothController.h"
+#include "chopper/Timer.h"
 #include <Sabertooth.h>
 #include <Bluepad32.h>
 #include "SettingsSystem.h"
+#include "SettingsUser.h"
+#include <algorithm>
 #include <vector>
 
 class SabertoothDrive {
@@ -34,7 +37,130 @@ public:
         return m_motors[motorId - 1];
     }
 
+    /*
+        Queues every command from this driver and its motors on a shared
+        serial bus, at the given priority.  nullptr writes directly.
+    */
+    void SetArbiter(SerialBusArbiter* arbiter, SerialBusArbiter::Priority priority) {
+        m_arbiter = arbiter;
+        m_priority = priority;
+        for (SabertoothController& motor : m_motors)
+            motor.SetArbiter(arbiter, priority);
+    }
+
+    /*
+        In mixed mode both motors are driven with one drive and one turn
+        command and the Sabertooth does the mixing:
+
+            motor 1 = drive + turn
+            motor 2 = drive - turn
+
+        Both motors change on the same packet, and a change in turn alone is
+        a single packet.  Set this before the first command is sent.
+    */
+    void SetMixedMode(bool isMixed) {
+        m_isMixed = isMixed;
+        m_drive.hasSent = false;
+        m_turn.hasSent = false;
+    }
+
+    bool IsMixedMode() const {
+        return m_isMixed;
+    }
+
+    /*
+        Programs the driver's own ramping, so it eases between the speeds it
+        is sent rather than the ESP32 sending every step in between.  See
+        RobotDriveBase::SetRampingValue() for the values, 0 is the default
+        ramp.  The Sabertooth keeps this across power cycles, so it is only
+        sent when it changes.
+    */
+    void SetRamping(int ramping) {
+        ramping = std::clamp(ramping, 0, 80);
+        if (ramping == m_ramping)
+            return;
+        // left unset if the bus had no room, so the next call tries again
+        if (!SabertoothController::SendCommand(m_sabertoothDriver, m_arbiter, m_priority, 16, (uint8_t)ramping))
+            return;
+        m_ramping = ramping;
+        DEBUG_MOTOR_PRINTF("ST[%d] ramping %d\n", m_sabertoothDriver.address(), ramping);
+    }
+
+    /*
+        Programs the driver to stop its motors when no command arrives for
+        this long, rounded up to 100 ms, even if the ESP32 itself has hung.
+        0 turns the timeout off.  Not kept across power cycles.
+    */
+    void SetSerialTimeout(uint64_t timeoutMs) {
+        int timeout = (int)std::min<uint64_t>((timeoutMs + 99) / 100, 127);
+        if (timeout == m_serialTimeout)
+            return;
+        if (!SabertoothController::SendCommand(m_sabertoothDriver, m_arbiter, m_priority, 14, (uint8_t)timeout))
+            return;
+        m_serialTimeout = timeout;
+        DEBUG_MOTOR_PRINTF("ST[%d] serial timeout %d00 ms\n", m_sabertoothDriver.address(), timeout);
+    }
+
+    /*
+        Sets motor 1 and motor 2 together, either as two motor commands or
+        as one mixed drive/turn pair.  Each motor's inversion is applied in
+        both modes.
+    */
+    void Set(float motor1, float motor2) {
+        if (!m_isMixed || m_motors.size() < 2) {
+            GetMotor(1).Set(motor1);
+            GetMotor(2).Set(motor2);
+            return;
+        }
+
+        motor1 = std::clamp(motor1, -1.0f, 1.0f);
+        motor2 = std::clamp(motor2, -1.0f, 1.0f);
+        if (m_motors[0].GetInverted())
+            motor1 *= -1;
+        if (m_motors[1].GetInverted())
+            motor2 *= -1;
+        int8_t drive = (int8_t)((motor1 + motor2) / 2.0f * (int8_t)127);
+        int8_t turn = (int8_t)((motor1 - motor2) / 2.0f * (int8_t)127);
+
+        // the Sabertooth waits for both a drive and a turn before it mixes,
+        // after that only the one that changed is sent
+        uint64_t now = Timer::GetFPGATimestamp();
+        if (m_drive.isDue(drive, now) &&
+            SabertoothController::SendThrottle(m_sabertoothDriver, m_arbiter, m_priority, 8, drive))
+            m_drive.sent(drive, now);
+        if (m_turn.isDue(turn, now) &&
+            SabertoothController::SendThrottle(m_sabertoothDriver, m_arbiter, m_priority, 10, turn))
+            m_turn.sent(turn, now);
+        DEBUG_MOTOR_PRINTF("ST[D]:%3d ST[T]:%3d ", drive, turn);
+    }
+
 private:
+    // Last value of a mixed command, repeated only as a keep-alive
+    struct MixedCommand {
+        int8_t value = 0;
+        uint64_t sendTime = 0;
+        bool hasSent = false;
+
+        bool isDue(int8_t newValue, uint64_t now) const {
+            return !hasSent || newValue != value || now - sendTime >= C110P_MOTOR_KEEPALIVE_MS;
+        }
+
+        // only once the packet was taken, so one the bus had no room for is tried again
+        void sent(int8_t newValue, uint64_t now) {
+            value = newValue;
+            sendTime = now;
+            hasSent = true;
+        }
+    };
+
     Sabertooth m_sabertoothDriver;
     std::vector<SabertoothController> m_motors; // Vector of motor controllers
+    bool m_isMixed = false;
+    SerialBusArbiter* m_arbiter = nullptr;
+    SerialBusArbiter::Priority m_priority = SerialBusArbiter::Priority::Drive;
+    MixedCommand m_drive;
+    MixedCommand m_turn;
+    // last values programmed into the driver, -1 until the first one
+    int m_ramping = -1;
+    int m_serialTimeout = -1;
 };
\ No newline at end of file
@@ -28,7 +28,12 @@ class SingleDrive : public RobotDriveBase
     SingleDrive(SingleDrive&&) = default;
     SingleDrive& operator=(SingleDrive&&) = default;
   
-    void ApplySpeedToMotor();
+    /**
+     * Stores the output and sends it to the motor after the speed limit.
+     *
+     * @param output Motor output [-1.0..1.0].
+     */
+    void ApplySpeedToMotor(float output);
     
     /**
      * Drive method for a single motor.
@@ -45,6 +50,11 @@ class SingleDrive : public RobotDriveBase
      */
     void StopMotor() override;
 
+    /**
+     * Scales the motor's last output while the motor safety ramps it down.
+     */
+    void RampMotor(float scale) override;
+
     /**
      * Gets the description of the drive.
      *
@@ -1,15 +1,35 @@
 #pragma once
 
 #include "chopper/drive/SingleDrive.h"
-#include "chopper/motorController/SabertoothController.h"
+#include "chopper/drive/SabertoothDrive.h"
 #include <Sabertooth.h>
 #include <Bluepad32.h>
 #include "SettingsSystem.h"
 
+/**
+ * A SingleDrive on one motor of a SyRen or Sabertooth, which also programs
+ * the driver's own ramping and serial timeout.
+ */
 class SingleDriveSabertooth : public SingleDrive
 { 
  public:
+  explicit SingleDriveSabertooth(SabertoothDrive& sabertoothDrive, int motorId = 1);
+
+  /**
+   * Sets the ramping and programs it into the driver.
+   */
   void SetRampingValue(int ramping);
   void SetDeadband(float deadband);
   void SetExpiration(uint64_t expirationTime);
+
+  /**
+   * Programs the driver to stop the motor by itself when no command arrives
+   * for this long, see DifferentialDriveSabertooth::SetSerialTimeout().
+   *
+   * @param timeoutMs Timeout, rounded up to 100 ms.  0 disables it.
+   */
+  void SetSerialTimeout(uint64_t timeoutMs);
+
+ protected:
+  SabertoothDrive& m_sabertoothDrive;
 };
@@ -4,6 +4,8 @@
 
 #include "chopper/motorController/MotorController.h"
 #include "chopper/MotorSafety.h"
+#include "chopper/Timer.h"
+#include "chopper/serial/SerialBusArbiter.h"
 #include <Sabertooth.h>
 #include <Bluepad32.h>
 
@@ -35,7 +37,42 @@ class SabertoothController : virtual public MotorController
 
   std::string GetDescription() const;
 
+  /**
+   * Queues this motor's commands on a shared serial bus instead of writing
+   * them straight away.
+   *
+   * @param arbiter  Bus the driver is on, nullptr to write directly.
+   * @param priority Priority of this motor's commands on the bus.
+   */
+  void SetArbiter(SerialBusArbiter* arbiter, SerialBusArbiter::Priority priority);
+
+  /**
+   * Sends a packet serial throttle command, e.g. motor 1 (0), drive (8) or
+   * turn (10).  The reverse command is the one after it.  Goes through the
+   * arbiter when there is one, where a stop from the drive is sent first.
+   *
+   * @return false if the arbiter had no room for it, so nothing was sent.
+   */
+  static bool SendThrottle(const Sabertooth& driver, SerialBusArbiter* arbiter,
+                           SerialBusArbiter::Priority priority, uint8_t command, int power);
+
+  /**
+   * Sends any packet serial command, e.g. serial timeout (14) or ramping
+   * (16), through the arbiter when there is one.
+   *
+   * @return false if the arbiter had no room for it, so nothing was sent.
+   */
+  static bool SendCommand(const Sabertooth& driver, SerialBusArbiter* arbiter,
+                          SerialBusArbiter::Priority priority, uint8_t command, uint8_t value);
+
  private:
   Sabertooth* m_sabertoothDriver = nullptr;
   uint8_t m_motorId = 0;
+  SerialBusArbiter* m_arbiter = nullptr;
+  SerialBusArbiter::Priority m_priority = SerialBusArbiter::Priority::Drive;
+
+  // Last command sent to the motor, repeated only as a keep-alive
+  int8_t m_lastSpeed = 0;
+  uint64_t m_lastSendTime = 0;
+  bool m_hasSent = false;
 };
@@ -0,0 +1,189 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <Arduino.h>
+#include "SettingsSystem.h"
+
+/*
+    Several Pololu devices daisy-chained on one serial port.
+
+    The Pololu protocol addresses every frame to a device number, so any
+    number of Maestros can listen on the same TX line.  Each device gets a
+    Port, a Stream of its own that queues what the device's driver writes.
+    flush() then interleaves the queued frames onto the wire, one frame per
+    port in turn, so a long setMultiTarget to one Maestro holds the other
+    up by at most one frame.
+
+    A frame starts at the only byte with its top bit set, the 0xAA
+    protocol byte (or the command byte of the compact protocol), which is
+    how the queue is split into frames without knowing every command.
+
+    Reading through a port first puts everything queued on the wire, so a
+    request always goes out before its reply is read.  Replies come back
+    on the shared RX line, the Maestro TX lines need to be joined with an
+    AND gate or diodes.
+
+        ESP TX ──┬──────────────┐
+                 │              │
+             [Maestro 12]   [Maestro 13]
+                 │              │
+        ESP RX ──┴───[ AND ]────┘
+*/
+class PololuBus
+{
+public:
+    static constexpr uint8_t kMaxPorts = 4;
+    static constexpr uint16_t kPortBufferSize = 256;
+
+    class Port : public Stream
+    {
+    public:
+        size_t write(uint8_t byte) override
+        {
+            if (byte & 0x80)
+            {
+                _isPassThrough = false;
+            }
+            if (!_isPassThrough && _count == kPortBufferSize)
+            {
+                // full in the middle of a frame, send this port's queue and
+                // the rest of the frame straight out so nothing lands inside it
+                _bus->drain(*this);
+                _isPassThrough = true;
+            }
+            if (_isPassThrough)
+            {
+                return _bus->_stream.write(byte);
+            }
+            _buffer[(_head + _count) % kPortBufferSize] = byte;
+            ++_count;
+            return 1;
+        }
+        using Print::write;
+
+        int available() override
+        {
+            _bus->flush();
+            return _bus->_stream.available();
+        }
+
+        int read() override
+        {
+            _bus->flush();
+            return _bus->_stream.read();
+        }
+
+        int peek() override
+        {
+            _bus->flush();
+            return _bus->_stream.peek();
+        }
+
+        void flush() override
+        {
+            _bus->flush();
+            _bus->_stream.flush();
+        }
+
+    private:
+        friend class PololuBus;
+
+        bool isEmpty() const
+        {
+            return _count == 0;
+        }
+
+        // Moves the oldest whole frame into out, returns its length
+        uint16_t takeFrame(uint8_t *out)
+        {
+            uint16_t length = 0;
+            do
+            {
+                out[length++] = _buffer[_head];
+                _head = (_head + 1) % kPortBufferSize;
+                --_count;
+            } while (_count > 0 && (_buffer[_head] & 0x80) == 0);
+            return length;
+        }
+
+        PololuBus *_bus = nullptr;
+        std::array<uint8_t, kPortBufferSize> _buffer = {};
+        uint16_t _head = 0;
+        uint16_t _count = 0;
+        bool _isPassThrough = false;
+    };
+
+    explicit PololuBus(Stream &stream) :
+        _stream(stream)
+    {
+    }
+
+    ~PololuBus() = default;
+
+    PololuBus(const PololuBus &) = delete;
+    PololuBus &operator=(const PololuBus &) = delete;
+
+    // A new port for one device on the bus
+    Port &addPort()
+    {
+        if (_portCount == kMaxPorts)
+        {
+            DEBUG_MAESTRO_PRINTF("PololuBus: only %u ports, sharing the last one\n", kMaxPorts);
+            return _ports[kMaxPorts - 1];
+        }
+        Port &port = _ports[_portCount++];
+        port._bus = this;
+        return port;
+    }
+
+    uint8_t portCount() const
+    {
+        return _portCount;
+    }
+
+    Stream &stream()
+    {
+        return _stream;
+    }
+
+    // Writes every queued frame, one frame per port in turn
+    void flush()
+    {
+        bool isSending = true;
+        while (isSending)
+        {
+            isSending = false;
+            for (uint8_t i = 0; i < _portCount; ++i)
+            {
+                // start each round with the port after the one that went first last time
+                Port &port = _ports[(_nextPort + i) % _portCount];
+                if (port.isEmpty())
+                {
+                    continue;
+                }
+                uint16_t length = port.takeFrame(_frame.data());
+                _stream.write(_frame.data(), length);
+                isSending = true;
+            }
+            _nextPort = _portCount > 0 ? (_nextPort + 1) % _portCount : 0;
+        }
+    }
+
+private:
+    // Writes everything queued on one port, in order
+    void drain(Port &port)
+    {
+        while (!port.isEmpty())
+        {
+            uint16_t length = port.takeFrame(_frame.data());
+            _stream.write(_frame.data(), length);
+        }
+    }
+
+    Stream &_stream;
+    std::array<Port, kMaxPorts> _ports = {};
+    uint8_t _portCount = 0;
+    uint8_t _nextPort = 0;
+    std::array<uint8_t, kPortBufferSize> _frame = {};
+};
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <Arduino.h>
+#include <SoftwareSerial.h>
+#include <driver/rmt_tx.h>
+
+/*
+    Serial port that transmits through an RMT channel, for links whose pins
+    have no hardware UART left.
+
+    Each byte is encoded once into RMT symbols (start bit, 8 data bits LSB
+    first, stop bit) and handed to the RMT peripheral, which clocks the bits
+    out on its own.  write() returns as soon as the bytes are queued instead
+    of bit-banging them on the CPU, and only blocks when every transmit
+    buffer is still on the wire.
+
+    Receiving is optional and still uses EspSoftwareSerial, which samples
+    edges in an interrupt rather than holding the CPU for the whole byte.
+
+        idle  start  d0 d1 d2 d3 d4 d5 d6 d7  stop  idle
+        ‾‾‾‾‾|_____|__|‾‾|__|__|‾‾|__|‾‾|__|‾‾‾‾‾‾‾‾‾‾‾
+*/
+class RmtSerial : public Stream
+{
+public:
+    RmtSerial() = default;
+    ~RmtSerial() { end(); }
+
+    RmtSerial(const RmtSerial &) = delete;
+    RmtSerial &operator=(const RmtSerial &) = delete;
+
+    // rxPin may be -1 for a transmit only link
+    bool begin(uint32_t baud, int8_t rxPin, int8_t txPin);
+    void end();
+
+    size_t write(uint8_t byte) override;
+    size_t write(const uint8_t *buffer, size_t size) override;
+    using Print::write;
+
+    int available() override;
+    int read() override;
+    int peek() override;
+
+    // Waits until everything written is on the wire
+    void flush() override;
+
+    operator bool() const
+    {
+        return _channel != nullptr;
+    }
+
+private:
+    static constexpr uint32_t kResolutionHz = 10000000;
+    static constexpr uint8_t kTransactions = 8;
+    static constexpr uint8_t kBytesPerTransaction = 16;
+    // 10 bits per byte, two bits per symbol
+    static constexpr uint8_t kSymbolsPerByte = 5;
+
+    using Symbols = std::array<rmt_symbol_word_t, kBytesPerTransaction * kSymbolsPerByte>;
+
+    static bool onTransmitDone(rmt_channel_handle_t channel, const rmt_tx_done_event_data_t *event, void *context);
+
+    // Sends up to kBytesPerTransaction bytes as one RMT transaction
+    bool transmit(const uint8_t *buffer, size_t size);
+
+    rmt_channel_handle_t _channel = nullptr;
+    rmt_encoder_handle_t _encoder = nullptr;
+    uint16_t _bitTicks = 0;
+
+    std::array<Symbols, kTransactions> _symbols = {};
+    // transactions queued and finished, the difference is how many buffers are busy
+    uint32_t _queued = 0;
+    std::atomic<uint32_t> _done = 0;
+
+    EspSoftwareSerial::UART _rx;
+    bool _hasRx = false;
+};
@@ -0,0 +1,196 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <Arduino.h>
+#include <wpi/mutex.h>
+#include "SettingsSystem.h"
+
+/*
+    Shares one serial line between several devices, e.g. the Sabertooth and
+    the SyRen on the same TX pin.
+
+    Devices submit packets instead of writing them, and the main loop
+    flushes once per frame.  Each packet has a slot, one per device and
+    channel, and a new packet for a slot replaces the one still waiting
+    there, so a superseded command never goes out on the wire.
+
+    A flush sends in priority order, oldest first within a priority, until
+    the frame's byte budget is spent.  Whatever does not fit waits for the
+    next frame, except:
+
+      - a drive stop always goes out
+      - a packet that has waited kMaxWaitFlushes frames goes out, after
+        everything of higher priority, so a busy drive cannot starve the dome
+
+    Both may overrun the budget for that frame, but never delay a packet of
+    higher priority.
+
+    flush() may also be called from another task, e.g. the motor safety
+    watchdog putting a stop on the wire while the main loop is stalled.
+    Flushes take turns, so packets always go out in the order they were
+    picked and a newer command is never overtaken by an older one.
+*/
+class SerialBusArbiter
+{
+public:
+    enum class Priority : uint8_t
+    {
+        DriveStop,
+        Drive,
+        Dome
+    };
+
+    static constexpr uint8_t kMaxPacketLength = 8;
+    static constexpr uint8_t kMaxSlots = 8;
+    static constexpr uint8_t kMaxWaitFlushes = 4;
+
+    SerialBusArbiter(Stream &stream, uint16_t bytesPerFrame) :
+        _stream(stream),
+        _bytesPerFrame(bytesPerFrame)
+    {
+    }
+
+    ~SerialBusArbiter() = default;
+
+    /*
+        Queues a packet for the next flush, replacing any packet still
+        waiting in the same slot.  Returns false if the packet is too long or
+        kMaxSlots other packets are already waiting, in which case nothing
+        was queued and the caller should try again next frame.
+    */
+    bool submit(uint16_t slot, Priority priority, const uint8_t *data, uint8_t length)
+    {
+        if (length == 0 || length > kMaxPacketLength)
+        {
+            return false;
+        }
+        std::scoped_lock lock(_mutex);
+        Packet *packet = find(slot);
+        if (packet == nullptr)
+        {
+            DEBUG_MOTOR_PRINTF("SerialBusArbiter: no free slot for %04x\n", slot);
+            return false;
+        }
+        if (!packet->isPending)
+        {
+            // a replaced packet keeps its place in line and how long it waited
+            packet->slot = slot;
+            packet->isPending = true;
+            packet->sequence = _sequence++;
+            packet->waited = 0;
+        }
+        packet->priority = priority;
+        packet->length = length;
+        std::memcpy(packet->data, data, length);
+        return true;
+    }
+
+    // Sends this frame's share of the waiting packets, call once per loop
+    void flush()
+    {
+        std::scoped_lock flushLock(_flushMutex);
+        std::array<Packet, kMaxSlots> outgoing;
+        uint8_t count = 0;
+        {
+            std::scoped_lock lock(_mutex);
+            std::array<Packet *, kMaxSlots> pending;
+            uint8_t pendingCount = 0;
+            for (Packet &packet : _packets)
+            {
+                if (packet.isPending)
+                {
+                    pending[pendingCount++] = &packet;
+                }
+            }
+            std::sort(pending.begin(), pending.begin() + pendingCount,
+                [](const Packet *a, const Packet *b) {
+                    if (a->priority != b->priority)
+                    {
+                        return a->priority < b->priority;
+                    }
+                    // sequence numbers wrap, so compare their distance
+                    return static_cast<int16_t>(a->sequence - b->sequence) < 0;
+                });
+
+            uint16_t budget = _bytesPerFrame;
+            for (uint8_t i = 0; i < pendingCount; ++i)
+            {
+                Packet &packet = *pending[i];
+                bool isUrgent = packet.priority == Priority::DriveStop || packet.waited >= kMaxWaitFlushes;
+                if (packet.length <= budget || isUrgent)
+                {
+                    budget -= std::min<uint16_t>(budget, packet.length);
+                    packet.isPending = false;
+                    outgoing[count++] = packet;
+                }
+                else
+                {
+                    ++packet.waited;
+                    ++_deferred;
+                }
+            }
+        }
+
+        // written outside the packet lock so devices are never held up by the wire
+        for (uint8_t i = 0; i < count; ++i)
+        {
+            _stream.write(outgoing[i].data, outgoing[i].length);
+            _bytesSent += outgoing[i].length;
+        }
+    }
+
+    // Total bytes written, and packets pushed to a later frame
+    uint32_t bytesSent() const
+    {
+        return _bytesSent;
+    }
+
+    uint32_t deferred() const
+    {
+        return _deferred;
+    }
+
+private:
+    struct Packet
+    {
+        uint16_t slot;
+        uint16_t sequence;
+        Priority priority;
+        uint8_t waited;
+        uint8_t length;
+        bool isPending;
+        uint8_t data[kMaxPacketLength];
+    };
+
+    // The packet waiting in a slot, else a free one; a slot is only held while its packet waits
+    Packet *find(uint16_t slot)
+    {
+        Packet *unused = nullptr;
+        for (Packet &packet : _packets)
+        {
+            if (packet.isPending && packet.slot == slot)
+            {
+                return &packet;
+            }
+            if (!packet.isPending && unused == nullptr)
+            {
+                unused = &packet;
+            }
+        }
+        return unused;
+    }
+
+    Stream &_stream;
+    uint16_t _bytesPerFrame;
+    std::array<Packet, kMaxSlots> _packets = {};
+    uint16_t _sequence = 0;
+    uint32_t _bytesSent = 0;
+    uint32_t _deferred = 0;
+    mutable wpi::mutex _mutex;
+    // held for a whole flush, picking and writing
+    wpi::mutex _flushMutex;
+};
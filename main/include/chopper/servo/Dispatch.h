@@ -4,8 +4,13 @@
 #include <PololuMaestro.h>
 // https://www.pololu.com/docs/0J40/5.e
 // https://www.pololu.com/docs/0J40/5.f
-#include "include/chopper/servo/ServoState.h"
-#include "include/settings/ServoPWM.h"
+#include <functional>
+#include <initializer_list>
+#include <span>
+#include <vector>
+#include "include/chopper/servo/MaestroCRC.h"
+#include "include/chopper/servo/ServoStates.h"
+#include "include/settings/ServoChannels.h"
 #include "include/chopper/Timer.h"
 
 class ServoDispatch : public MiniMaestro
@@ -13,119 +18,75 @@ class ServoDispatch : public MiniMaestro
 public:
     ServoDispatch(Stream &stream, uint8_t resetPin = noResetPin, uint8_t deviceNumber = deviceNumberDefault, bool CRCEnabled = false, uint8_t channels = 24) : 
         MiniMaestro(stream, resetPin, deviceNumber, CRCEnabled), 
-        _channels(channels), 
-        _servoStates(channels, ServoState()),
-        _channelTargets(channels, 0),
-        _previousTargets(channels, 0)
+        _port(&stream),
+        _deviceNumber(deviceNumber),
+        _CRCEnabled(CRCEnabled),
+        _channels(std::min(channels, ServoStates::kMaxChannels)), 
+        _servoStates(channels)
     {
-        setupBodyMaestro(deviceNumber);
-        setupDomeMaestro(deviceNumber);
+        _channelTargets.fill(0);
+        _previousTargets.fill(0);
+        _frame.reserve(kMaxMultiTargetLength);
+        // The UART is not running yet, so only the local state is loaded here.
+        // Speed and acceleration are sent to the Maestro in begin().
+        for (const ServoChannelConfig &config : channelConfig())
+        {
+            if (config.channel >= _channels)
+            {
+                DEBUG_MAESTRO_PRINTF("Servo %d exceeds channel count %d\n", config.channel, _channels);
+                continue;
+            }
+            _servoStates.setRange(config.channel, config.minPulse, config.maxPulse, config.neutralPulse);
+            if (config.easing != nullptr)
+            {
+                _servoStates.setEasingMethod(config.channel, config.easing);
+            }
+            _servoStates.setPosition(config.channel, config.neutralPulse);
+            _servoStates.setManual(config.channel, config.manual);
+            _servoStates.setPower(config.channel, config.idleHold, config.current);
+        }
+        _servoStates.setPowerBudget(powerBudget());
     };
     ~ServoDispatch() = default;
 
-    void setupBodyMaestro(uint8_t deviceNumber)
+    /*
+        Programs speed and acceleration for every configured channel.  
+        
+        Must be called after the serial port has been initialized.  All 
+        commands are encoded into a single buffer and sent with one write, 
+        so boot time no longer depends on the number of configured channels.
+    */
+    void begin()
     {
-        if (deviceNumber != MAESTRO_BODY_ID)
+        std::span<const ServoChannelConfig> config = channelConfig();
+        std::vector<uint8_t> buffer;
+        buffer.reserve(config.size() * 2 * kMaxCommandLength);
+        [[maybe_unused]] unsigned programmed = 0;
+        for (const ServoChannelConfig &channel : config)
         {
-            return;
+            if (channel.channel >= _channels)
+            {
+                continue;
+            }
+            appendCommand(buffer, kSetSpeedCommand, channel.channel, channel.speed);
+            appendCommand(buffer, kSetAccelerationCommand, channel.channel, channel.acceleration);
+            ++programmed;
         }
-
-        for (uint8_t i = 0; i < _channels; ++i)
-         {
-             switch(i)
-             {
-                case MAESTRO_BODY_NECK_A:
-                    MiniMaestro::setSpeed(i, MAESTRO_BODY_NECK_A_SPEED);
-                    MiniMaestro::setAcceleration(i, MAESTRO_BODY_NECK_A_ACCEL);
-                    _servoStates[i].setRange(MAESTRO_BODY_NECK_A_MIN, MAESTRO_BODY_NECK_A_MAX, MAESTRO_BODY_NECK_A_NEUTRAL);
-                    // _servoStates[i].setEasingMethod(Easing::LinearInterpolation);
-                    _servoStates[i].setPosition(MAESTRO_BODY_NECK_A_NEUTRAL);
-                    _servoStates[i].setManual(MAESTRO_BODY_NECK_A_MANUAL);
-                    break;
-                case MAESTRO_BODY_NECK_B:
-                    MiniMaestro::setSpeed(i, MAESTRO_BODY_NECK_B_SPEED);
-                    MiniMaestro::setAcceleration(i, MAESTRO_BODY_NECK_B_ACCEL);
-                    _servoStates[i].setRange(MAESTRO_BODY_NECK_B_MIN, MAESTRO_BODY_NECK_B_MAX, MAESTRO_BODY_NECK_B_NEUTRAL);
-                    // _servoStates[i].setEasingMethod(Easing::LinearInterpolation);
-                    _servoStates[i].setPosition(MAESTRO_BODY_NECK_B_NEUTRAL);
-                    _servoStates[i].setManual(MAESTRO_BODY_NECK_B_MANUAL);
-                    break;
-                case MAESTRO_BODY_NECK_C:
-                    MiniMaestro::setSpeed(i, MAESTRO_BODY_NECK_C_SPEED);
-                    MiniMaestro::setAcceleration(i, MAESTRO_BODY_NECK_C_ACCEL);
-                    _servoStates[i].setRange(MAESTRO_BODY_NECK_C_MIN, MAESTRO_BODY_NECK_C_MAX, MAESTRO_BODY_NECK_C_NEUTRAL);
-                    // _servoStates[i].setEasingMethod(Easing::LinearInterpolation);
-                    _servoStates[i].setPosition(MAESTRO_BODY_NECK_C_NEUTRAL);
-                    _servoStates[i].setManual(MAESTRO_BODY_NECK_C_MANUAL);
-                    break;
-                 case MAESTRO_UTILITY_ARM:
-                     MiniMaestro::setSpeed(i, MAESTRO_UTILITY_ARM_SPEED);
-                     MiniMaestro::setAcceleration(i, MAESTRO_UTILITY_ARM_ACCEL);
-                     _servoStates[i].setRange(MAESTRO_UTILITY_ARM_MIN, MAESTRO_UTILITY_ARM_MAX, MAESTRO_UTILITY_ARM_NEUTRAL);
-                     _servoStates[i].setEasingMethod(MAESTRO_UTILITY_ARM_EASING);
-                     _servoStates[i].setPosition(MAESTRO_UTILITY_ARM_NEUTRAL);
-                     break;
-                 default:
-                    DEBUG_MAESTRO_PRINTF("Servo %d not configured\n", i);
-                    break;
-             }
-         }
-    }
-
-    void setupDomeMaestro(uint8_t deviceNumber)
-    {
-        if (deviceNumber != MAESTRO_DOME_ID)
+        if (buffer.empty())
         {
+            DEBUG_MAESTRO_PRINTF("Maestro %d has no configured channels\n", _deviceNumber);
             return;
         }
-        for (uint8_t i = 0; i < _channels; ++i)
-        {
-            switch(i)
-            {
-                case MAESTRO_DOME_PERISCOPE_LIFT:
-                     MiniMaestro::setSpeed(i, MAESTRO_DOME_PERISCOPE_LIFT_SPEED);
-                     MiniMaestro::setAcceleration(i, MAESTRO_DOME_PERISCOPE_LIFT_ACCEL);
-                     _servoStates[i].setRange(MAESTRO_DOME_PERISCOPE_LIFT_MIN, MAESTRO_DOME_PERISCOPE_LIFT_MAX, MAESTRO_DOME_PERISCOPE_LIFT_NEUTRAL);
-                     _servoStates[i].setEasingMethod(MAESTRO_DOME_PERISCOPE_LIFT_EASING);
-                     _servoStates[i].setPosition(MAESTRO_DOME_PERISCOPE_LIFT_NEUTRAL);
-                     break;
-                 case MAESTRO_DOME_PERISCOPE_SPIN:
-                     MiniMaestro::setSpeed(i, MAESTRO_DOME_PERISCOPE_SPIN_SPEED);
-                     MiniMaestro::setAcceleration(i, MAESTRO_DOME_PERISCOPE_SPIN_ACCEL);
-                     _servoStates[i].setRange(MAESTRO_DOME_PERISCOPE_SPIN_MIN, MAESTRO_DOME_PERISCOPE_SPIN_MAX, MAESTRO_DOME_PERISCOPE_SPIN_NEUTRAL);
-                     _servoStates[i].setEasingMethod(MAESTRO_DOME_PERISCOPE_SPIN_EASING);
-                     _servoStates[i].setPosition(MAESTRO_DOME_PERISCOPE_SPIN_NEUTRAL);
-                     break;
-                case MAESTRO_DOME_DOOR_LEFT:
-                     MiniMaestro::setSpeed(i, MAESTRO_DOME_DOOR_LEFT_SPEED);
-                     MiniMaestro::setAcceleration(i, MAESTRO_DOME_DOOR_LEFT_ACCEL);
-                     _servoStates[i].setRange(MAESTRO_DOME_DOOR_LEFT_MIN, MAESTRO_DOME_DOOR_LEFT_MAX, MAESTRO_DOME_DOOR_LEFT_NEUTRAL);
-                     _servoStates[i].setEasingMethod(MAESTRO_DOME_DOOR_LEFT_EASING);
-                     _servoStates[i].setPosition(MAESTRO_DOME_DOOR_LEFT_NEUTRAL);
-                     break;
-                case MAESTRO_DOME_DOOR_RIGHT:
-                     MiniMaestro::setSpeed(i, MAESTRO_DOME_DOOR_RIGHT_SPEED);
-                     MiniMaestro::setAcceleration(i, MAESTRO_DOME_DOOR_RIGHT_ACCEL);
-                     _servoStates[i].setRange(MAESTRO_DOME_DOOR_RIGHT_MIN, MAESTRO_DOME_DOOR_RIGHT_MAX, MAESTRO_DOME_DOOR_RIGHT_NEUTRAL);
-                     _servoStates[i].setEasingMethod(MAESTRO_DOME_DOOR_RIGHT_EASING);
-                     _servoStates[i].setPosition(MAESTRO_DOME_DOOR_RIGHT_NEUTRAL);
-                     break;
-                default:
-                    DEBUG_MAESTRO_PRINTF("Servo %d not configured\n", i);
-                    break;
-            }
-        }
+        _port->write(buffer.data(), buffer.size());
+        DEBUG_MAESTRO_PRINTF("Maestro %d programmed %u channels in %u bytes\n", _deviceNumber, programmed, static_cast<unsigned>(buffer.size()));
     }
 
     void animate()
     {
-        uint64_t currentTime = Timer::GetFPGATimestamp();
-        for (uint8_t i = 0; i < _channels; ++i)
-        {
-            // setMultiTarget command requires the target to be in 1/4 microsecond units, so we multiply by 4
-            _channelTargets[i] = _servoStates[i].getNextPulse(currentTime) * 4;
-        }
-        if (!std::equal(_channelTargets.begin(), _channelTargets.end(), _previousTargets.begin()))
+        uint64_t now = Timer::GetFPGATimestamp();
+        // setMultiTarget command requires the target to be in 1/4 microsecond units
+        _servoStates.animate(now, _channelTargets.data());
+        if (!std::equal(_channelTargets.begin(), _channelTargets.begin() + _channels, _previousTargets.begin()))
         {
             DEBUG_MAESTRO_PRINTF("Setting targets: ");
             for (uint8_t i = 0; i < _channels; ++i)
@@ -133,71 +94,380 @@ public:
                 DEBUG_MAESTRO_PRINTF("%d ", _channelTargets[i]);
             }
             DEBUG_MAESTRO_PRINTF("\n");
-            MiniMaestro::setMultiTarget(_channels, 0, _channelTargets.data());
+            _frame.clear();
+            beginFrame(_frame, kSetMultipleTargetsCommand);
+            appendData(_frame, _channels);
+            appendData(_frame, 0);
+            for (uint8_t i = 0; i < _channels; ++i)
+            {
+                appendData(_frame, _channelTargets[i] & 0x7F);
+                appendData(_frame, (_channelTargets[i] >> 7) & 0x7F);
+            }
+            endFrame(_frame);
+            _port->write(_frame.data(), _frame.size());
             _previousTargets = _channelTargets;
         }
+        pollErrors(now);
     }
 
     void enable(uint8_t channel)
     {
         /*
-            This command enables the specified channel.  A target value of 0 
-            tells the Maestro to stop sending pulses to the servo.
+            Powers the channel on the next animate(), as long as the BEC 
+            budget allows.
         */
-        _servoStates[channel].setEnable(true);
+        _servoStates.requestEnable(channel);
     }
 
     void disable(uint8_t channel)
     {
         /*
-            This command disables the specified channel.  A target value 
-            of 0 tells the Maestro to stop sending pulses to the servo.
+            Stops the channel on the next animate().  A target value of 0 
+            tells the Maestro to stop sending pulses to the servo, and goes 
+            out in the same setMultiTarget as every other channel.
         */
-        _channelTargets[channel] = 0;
-        _servoStates[channel].setEnable(false);
-        MiniMaestro::setTarget(channel, 0);
+        _servoStates.setEnable(channel, false);
     }
 
     void disableAll()
     {
-        std::fill(_channelTargets.begin(), _channelTargets.end(), 0);
         for (uint8_t i = 0; i < _channels; ++i)
         {
-            _servoStates[i].setEnable(false);
+            _servoStates.setEnable(i, false);
         }
         animate();
     }
 
     void setPosition(uint8_t channel, uint16_t position)
     {
-        _servoStates[channel].setPosition(position);
+        _servoStates.setPosition(channel, position);
     }
 
-    void setTimedMovement(uint8_t channel, uint16_t startPosition, uint16_t finishPosition, uint32_t startTime, uint32_t duration)
+    void setTimedMovement(uint8_t channel, uint16_t startPosition, uint16_t finishPosition, uint64_t startTime, uint32_t duration, bool scaleDuration = true)
     {
-        _servoStates[channel].setTargets(startPosition, finishPosition, startTime, startTime + duration);
-        if (_servoStates[channel].isFinishedMoving())
+        _servoStates.setTargets(channel, startPosition, finishPosition, startTime, startTime + duration, scaleDuration);
+        // Once the servo has held its finish position for its idle hold time 
+        // it is powered down in animate() to prevent PWM searching/jitter
+        if (!_servoStates.isFinishedMoving(channel))
         {
-            // Servo has reached finish position, disable it to prevent PWM searching/jitter
-            _servoStates[channel].setEnable(false);
+            _servoStates.requestEnable(channel);
         }
-        else
+    }
+
+    /*
+        Sends commands without the 0xAA and device number bytes, which
+        saves 2 of the 6 bytes per setTarget, and more on a CRC link.  Every
+        device on the line acts on a compact command, so only use it when 
+        this Maestro is alone on its link.
+    */
+    void setCompactProtocol(bool isCompact)
+    {
+        _isCompact = isCompact;
+    }
+
+    bool isCompactProtocol() const
+    {
+        return _isCompact || _deviceNumber == deviceNumberDefault;
+    }
+
+    /*
+        Reads and clears the Maestro's error register.  Unlike getErrors()
+        this tells a missing reply apart from no errors, returns false if
+        the Maestro did not answer.
+    */
+    bool readErrors(uint16_t &errors)
+    {
+        // a reply still due to pollErrors() is thrown away with the rest
+        _errorPollOwner = nullptr;
+        drainReplies();
+        sendGetErrors();
+
+        uint8_t reply[2];
+        if (_port->readBytes(reply, sizeof(reply)) != sizeof(reply) || reply[1] > kMaxErrorsHighByte)
+        {
+            return false;
+        }
+        errors = reply[0] | (reply[1] << 8);
+        return true;
+    }
+
+    /*
+        Steps a link up to the fastest baud rate a Maestro on it answers.
+
+        In its detect baud mode a Maestro picks up the baud rate from the 
+        first 0xAA it receives after power up and keeps it, so the rates are
+        tried fastest first.  A freshly powered Maestro locks onto the first
+        one, and a Maestro that kept its rate across an ESP32 reset is found
+        further down the list.  A device answers a rate once it has replied
+        to getErrors kVerifyReads times in a row.
+
+        The first rate any device answers is taken, even if another device
+        does not: the one that answered is locked to it, and moving on down
+        the list would lose it too.  isAnswering() tells which devices did.
+
+        setBaudRate switches the UART, rates should be in descending order.
+        Returns the rate in use, or 0 if no device answered at any rate.
+    */
+    static uint32_t negotiateBaud(std::initializer_list<ServoDispatch *> devices, std::span<const uint32_t> baudRates,
+        const std::function<void(uint32_t)> &setBaudRate)
+    {
+        for (uint32_t baudRate : baudRates)
         {
-            _servoStates[channel].setEnable(true);
+            setBaudRate(baudRate);
+            bool isAnyAnswering = false;
+            for (ServoDispatch *device : devices)
+            {
+                device->_isAnswering = device->verifyLink();
+                isAnyAnswering |= device->_isAnswering;
+            }
+            if (isAnyAnswering)
+            {
+                DEBUG_MAESTRO_PRINTF("Maestro link at %u baud\n", static_cast<unsigned>(baudRate));
+                return baudRate;
+            }
+            DEBUG_MAESTRO_PRINTF("Maestro link not answering at %u baud\n", static_cast<unsigned>(baudRate));
         }
+        return 0;
+    }
+
+    // Whether the Maestro answered at the rate negotiateBaud() settled on
+    bool isAnswering() const
+    {
+        return _isAnswering;
+    }
+
+    uint8_t deviceNumber() const
+    {
+        return _deviceNumber;
+    }
+
+    /*
+        How often the Maestro has flagged each bit of its error register
+        since boot, e.g. bit 3 counts the frames it dropped on a CRC error.
+        Polled in the background by animate().
+    */
+    struct ErrorCounts
+    {
+        std::array<uint32_t, 9> bits;
+        uint32_t replies;
+        uint32_t missedReplies;
+    };
+
+    const ErrorCounts &errorCounts() const
+    {
+        return _errorCounts;
+    }
+
+    uint16_t getPosition(uint8_t channel) const
+    {
+        return _servoStates.getPosition(channel);
     }
 
     bool isFinishedMoving(uint8_t channel)
     {
-        return _servoStates[channel].isFinishedMoving();
+        return _servoStates.isFinishedMoving(channel);
     }
 
 
 private:
+    // Replies to getErrors kVerifyReads times in a row at the current rate
+    bool verifyLink()
+    {
+        _port->setTimeout(kNegotiationTimeoutMs);
+        uint16_t errors = 0;
+        for (uint8_t i = 0; i < kVerifyReads; ++i)
+        {
+            // the first read also clears the serial errors left by faster attempts
+            if (!readErrors(errors))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // https://www.pololu.com/docs/0J40/5.c
+    static constexpr uint8_t kProtocolIdentifier = 0xAA;
+    static constexpr uint8_t kSetSpeedCommand = 0x87;
+    static constexpr uint8_t kSetAccelerationCommand = 0x89;
+    static constexpr uint8_t kSetMultipleTargetsCommand = 0x9F;
+    static constexpr uint8_t kGetErrorsCommand = 0xA1;
+    // protocol identifier, device, command, channel, two data bytes and CRC
+    static constexpr size_t kMaxCommandLength = 7;
+    // protocol identifier, device, command, count, first channel, two bytes per channel and CRC
+    static constexpr size_t kMaxMultiTargetLength = 6 + 2 * ServoStates::kMaxChannels;
+    // the error register is 9 bits
+    static constexpr uint8_t kMaxErrorsHighByte = 0x01;
+    static constexpr uint8_t kVerifyReads = 3;
+    static constexpr uint16_t kNegotiationTimeoutMs = 20;
+    static constexpr uint16_t kErrorReplyTimeoutMs = 50;
+
+    uint32_t powerBudget() const
+    {
+        switch (_deviceNumber)
+        {
+            case MAESTRO_BODY_ID:
+                return C110P_SERVO_BODY_BEC_BUDGET_MA;
+            case MAESTRO_DOME_ID:
+                return C110P_SERVO_DOME_BEC_BUDGET_MA;
+            default:
+                return UINT32_MAX;
+        }
+    }
+
+    std::span<const ServoChannelConfig> channelConfig() const
+    {
+        switch (_deviceNumber)
+        {
+            case MAESTRO_BODY_ID:
+                return kMaestroBodyChannels;
+            case MAESTRO_DOME_ID:
+                return kMaestroDomeChannels;
+            default:
+                return {};
+        }
+    }
+
+    void appendCommand(std::vector<uint8_t> &buffer, uint8_t command, uint8_t channel, uint16_t value)
+    {
+        beginFrame(buffer, command);
+        appendData(buffer, channel & 0x7F);
+        appendData(buffer, value & 0x7F);
+        appendData(buffer, (value >> 7) & 0x7F);
+        endFrame(buffer);
+    }
+
+    /*
+        The CRC is carried along as each byte is queued, one table lookup
+        per byte, so closing a frame only has to append it.
+    */
+    void beginFrame(std::vector<uint8_t> &buffer, uint8_t command, bool isAddressed = false)
+    {
+        _crc = 0;
+        if (isCompactProtocol() && !isAddressed)
+        {
+            // Compact protocol
+            appendData(buffer, command);
+        }
+        else
+        {
+            // Pololu protocol
+            appendData(buffer, kProtocolIdentifier);
+            appendData(buffer, _deviceNumber & 0x7F);
+            appendData(buffer, command & 0x7F);
+        }
+    }
+
+    void appendData(std::vector<uint8_t> &buffer, uint8_t data)
+    {
+        buffer.push_back(data);
+        _crc = MaestroCRC::update(_crc, data);
+    }
+
+    void endFrame(std::vector<uint8_t> &buffer) const
+    {
+        if (_CRCEnabled)
+        {
+            buffer.push_back(_crc);
+        }
+    }
+
+    void sendGetErrors()
+    {
+        _frame.clear();
+        beginFrame(_frame, kGetErrorsCommand, true);
+        endFrame(_frame);
+        _port->write(_frame.data(), _frame.size());
+    }
+
+    void drainReplies()
+    {
+        while (_port->available() > 0)
+        {
+            _port->read();
+        }
+    }
+
+    /*
+        Reads the error register without blocking the loop.  The request goes
+        out with this frame's targets and the reply is picked up by a later
+        animate() once both bytes have arrived.  Every Maestro answers on the
+        same RX line, so only one request is outstanding at a time.
+    */
+    void pollErrors(uint64_t now)
+    {
+        if (_errorPollOwner == this)
+        {
+            if (_port->available() >= 2)
+            {
+                uint8_t reply[2];
+                _port->readBytes(reply, sizeof(reply));
+                _errorPollOwner = nullptr;
+                _lastErrorPoll = now;
+                if (reply[1] > kMaxErrorsHighByte)
+                {
+                    // out of step with the replies, start over from an empty line
+                    ++_errorCounts.missedReplies;
+                    drainReplies();
+                    return;
+                }
+                countErrors(reply[0] | (reply[1] << 8));
+            }
+            else if (now - _errorRequestTime >= kErrorReplyTimeoutMs)
+            {
+                DEBUG_MAESTRO_PRINTF("Maestro %d did not answer getErrors\n", _deviceNumber);
+                ++_errorCounts.missedReplies;
+                _errorPollOwner = nullptr;
+                _lastErrorPoll = now;
+                drainReplies();
+            }
+            return;
+        }
+        if (_errorPollOwner == nullptr && now - _lastErrorPoll >= C110P_SERVO_ERROR_POLL_MS)
+        {
+            drainReplies();
+            sendGetErrors();
+            _errorPollOwner = this;
+            _errorRequestTime = now;
+        }
+    }
+
+    void countErrors(uint16_t errors)
+    {
+        ++_errorCounts.replies;
+        if (errors == 0)
+        {
+            return;
+        }
+        DEBUG_MAESTRO_PRINTF("Maestro %d errors: %03x\n", _deviceNumber, errors);
+        for (uint8_t bit = 0; bit < _errorCounts.bits.size(); ++bit)
+        {
+            if (errors & (1 << bit))
+            {
+                ++_errorCounts.bits[bit];
+            }
+        }
+    }
+
+    Stream *_port;
+    uint8_t _deviceNumber;
+    bool _isAnswering = false;
+    bool _CRCEnabled;
+    bool _isCompact = false;
+    // CRC of the frame being built
+    uint8_t _crc = 0;
     uint8_t _channels;
-    std::vector<uint16_t> _channelTargets;
-    std::vector<uint16_t> _previousTargets;
-    std::vector<ServoState> _servoStates;
+    ServoStates _servoStates;
+    std::array<uint16_t, ServoStates::kMaxChannels> _channelTargets;
+    std::array<uint16_t, ServoStates::kMaxChannels> _previousTargets;
+    // reused for every frame so animate() does not allocate
+    std::vector<uint8_t> _frame;
+
+    ErrorCounts _errorCounts = {};
+    uint64_t _lastErrorPoll = 0;
+    uint64_t _errorRequestTime = 0;
+    // the device waiting on a getErrors reply, if any
+    static inline ServoDispatch *_errorPollOwner = nullptr;
 };
 
 #endif // CHOPPER_SERVO_DISPATCH_H
\ No newline at end of file
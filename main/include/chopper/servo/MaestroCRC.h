@@ -0,0 +1,68 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+/*
+    CRC-7 of the Pololu serial protocol, one table lookup per byte.
+
+    The Maestro's CRC runs the bits of each byte LSB first through the
+    polynomial 0x91 (x^7 + x^3 + 1, reflected).  Eight of those bit steps
+    only depend on the CRC XOR the byte, so they are folded into a 256 entry
+    table built at compile time, which lives in flash.
+
+    The CRC is updated as each byte of a frame is queued, and the last value
+    is appended as the frame's final byte.
+    ref: https://www.pololu.com/docs/0J40/5.d
+*/
+class MaestroCRC
+{
+public:
+    static constexpr uint8_t kPolynomial = 0x91;
+
+    static constexpr uint8_t update(uint8_t crc, uint8_t byte)
+    {
+        return kTable[crc ^ byte];
+    }
+
+    static constexpr uint8_t compute(const uint8_t *data, size_t length, uint8_t crc = 0)
+    {
+        for (size_t i = 0; i < length; ++i)
+        {
+            crc = update(crc, data[i]);
+        }
+        return crc;
+    }
+
+    // Bit at a time, as in the protocol documentation
+    static constexpr uint8_t updateBitwise(uint8_t crc, uint8_t byte)
+    {
+        crc ^= byte;
+        for (uint8_t bit = 0; bit < 8; ++bit)
+        {
+            if (crc & 0x01)
+            {
+                crc ^= kPolynomial;
+            }
+            crc >>= 1;
+        }
+        return crc;
+    }
+
+private:
+    static constexpr std::array<uint8_t, 256> buildTable()
+    {
+        std::array<uint8_t, 256> table = {};
+        for (size_t i = 0; i < table.size(); ++i)
+        {
+            table[i] = updateBitwise(0, static_cast<uint8_t>(i));
+        }
+        return table;
+    }
+
+    static const std::array<uint8_t, 256> kTable;
+};
+
+// defined once the class is complete so buildTable() can run at compile time
+inline constexpr std::array<uint8_t, 256> MaestroCRC::kTable = MaestroCRC::buildTable();
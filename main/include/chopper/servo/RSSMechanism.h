@@ -1,15 +1,27 @@
 #pragma once
 
 #include "include/MathUtil.h"
+#include "include/SettingsUser.h"
 #include "include/chopper/Timer.h"
 #include "include/chopper/dome/RSSMachine.h"
+#include "include/chopper/dome/RSSLegTable.h"
+#include "include/chopper/dome/RSSPosePlanner.h"
+#include "include/chopper/dome/RSSGesture.h"
 
 class RSSMechanism : public RSSMachine
 {
 public:
     // Constructor
     RSSMechanism(float base_altitude, float end_effector_altitude, float bottom_link_length, float top_link_length, float min_height, float limit_normal_vector, bool bend_out)
-        : RSSMachine(base_altitude, end_effector_altitude, bottom_link_length, top_link_length, min_height, limit_normal_vector, bend_out)
+        : RSSMachine(base_altitude, end_effector_altitude, bottom_link_length, top_link_length, min_height, limit_normal_vector, bend_out),
+        _planner(
+            {
+                C110P_RSS_MECHANISM_TILT_VELOCITY,
+                C110P_RSS_MECHANISM_TILT_ACCELERATION,
+                C110P_RSS_MECHANISM_HEIGHT_VELOCITY,
+                C110P_RSS_MECHANISM_HEIGHT_ACCELERATION
+            },
+            C110P_RSS_MECHANISM_PLANNER_TICK_MS)
     {
         // Constructor implementation
         _platformCurrentHeight = (_platformMinHeight + _platformMaxHeight) / 2.0f;
@@ -110,23 +122,55 @@ public:
         _platformCurrentHeight = std::min(_platformMaxHeight, std::max(_platformMinHeight, height));
     }
 
+    /*
+        Precomputes leg PWM over the joystick range and height range, so
+        getLegPWMFromJoystick() interpolates instead of solving the IK each 
+        frame.  Call after the pulse ranges and actuation range are set.
+    */
+    void buildLegTable()
+    {
+        // joystick is scaled to +/- the normal vector limit, then rotated
+        float range = _limitNormalVector * static_cast<float>(M_SQRT2);
+        _legTable.build(
+            [this](float nx, float ny, float hz) {
+                std::array<float, 3> legs = solveLegAngles(nx, ny, hz);
+                for (size_t i = 0; i < legs.size(); ++i)
+                {
+                    // unreachable poses take the same limit getLegAngles() would give them
+                    float angle = std::isnan(legs[i]) ? clampLegAngle(legs[i]) : legs[i];
+                    legs[i] = angleToPWM(angle) + _servoOffsetPWM[i];
+                }
+                return legs;
+            },
+            range,
+            _platformMinHeight,
+            _platformMaxHeight);
+    }
+
+    float legTableMaxError() const
+    {
+        return _legTable.maxError();
+    }
+
     void calculateLegOffsets()
     {
+        _legTable.invalidate();
+        _hasEstimate = false;
         uint16_t platformMinHeightPWM = mapAngleToPWM(_platformMinHeightAngle);
         uint16_t platformMaxHeightPWM = mapAngleToPWM(_platformMaxHeightAngle);
-        uint16_t offset = 0;
+        int offset = 0;
 
         for (size_t i = 0; i < 3; ++i)
         {
             if (_servoMinPulse[i] != 0 && _servoMaxPulse[i] == 0)
             {
                 offset = std::max(_referenceMinPWM, _referenceMaxPWM) - std::max(platformMinHeightPWM, platformMaxHeightPWM);
-                _servoOffsetPWM[i] = offset + (_servoMinPulse[i] - _referenceMinPWM);
+                _servoOffsetPWM[i] = static_cast<int16_t>(offset + (_servoMinPulse[i] - _referenceMinPWM));
             }
             else if (_servoMinPulse[i] == 0 || _servoMaxPulse[i] != 0)
             {
                 offset = std::min(_referenceMinPWM, _referenceMaxPWM) - std::min(platformMinHeightPWM, platformMaxHeightPWM);
-                _servoOffsetPWM[i] = offset + (_servoMaxPulse[i] - _referenceMaxPWM);
+                _servoOffsetPWM[i] = static_cast<int16_t>(offset + (_servoMaxPulse[i] - _referenceMaxPWM));
             }
             else
             {
@@ -135,13 +179,24 @@ public:
                 ) + (
                     std::min(_referenceMinPWM, _referenceMaxPWM) - std::min(platformMinHeightPWM, platformMaxHeightPWM)
                 ) / 2;
-                _servoOffsetPWM[i] = offset + (
+                _servoOffsetPWM[i] = static_cast<int16_t>(offset + (
                     (_servoMinPulse[i] - _referenceMinPWM) + (_servoMaxPulse[i] - _referenceMaxPWM)
-                ) / 2;
+                ) / 2);
             }
+#if defined(C110P_RSS_MECHANISM_LEG_OFFSET_PWM_A) && defined(C110P_RSS_MECHANISM_LEG_OFFSET_PWM_B) && defined(C110P_RSS_MECHANISM_LEG_OFFSET_PWM_C)
+            // offsets from tools/rss_calibrate replace the estimate above
+            {
+                const int16_t calibrated[3] = {
+                    C110P_RSS_MECHANISM_LEG_OFFSET_PWM_A,
+                    C110P_RSS_MECHANISM_LEG_OFFSET_PWM_B,
+                    C110P_RSS_MECHANISM_LEG_OFFSET_PWM_C
+                };
+                _servoOffsetPWM[i] = calibrated[i];
+            }
+#endif
             _servoOffsetAngle[i] = mapPWMToAngle(_servoOffsetPWM[i]);
             DEBUG_RSS_MACHINE_PRINTF(
-                "RSS[Leg]: %zu: minPulse: %u maxPulse: %u offsetPulse: %u offsetAngle: %4.2f, relativeAngleOffset: %4.2f\n", 
+                "RSS[Leg]: %zu: minPulse: %u maxPulse: %u offsetPulse: %d offsetAngle: %4.2f, relativeAngleOffset: %4.2f\n", 
                 i, _servoMinPulse[i], _servoMaxPulse[i], _servoOffsetPWM[i], _servoOffsetAngle[i], _servoOffsetAngle[i] - mapPWMToAngle(offset)
             );
         }
@@ -187,32 +242,139 @@ public:
         return legs;
     }
 
+    /*
+        Reseeds the motion planner from where the legs actually are, e.g.
+        the positions the Maestro is holding when the neck is enabled.  
+        Servos that are switched off (0) give nothing to estimate from.
+    */
+    void syncPose(const std::array<uint16_t, 3> &legPWM)
+    {
+        if (std::find(legPWM.begin(), legPWM.end(), 0) != legPWM.end())
+        {
+            return;
+        }
+        RSSForwardKinematics::Result estimate = estimatePose(legPWM);
+        if (estimate.converged)
+        {
+            _planner.reset(estimate.pose, Timer::GetFPGATimestamp());
+        }
+    }
+
+    /*
+        Plays a canned gesture on top of the joystick from now, see 
+        RSSGesture.  Only while enabled, and once per button press.
+    */
+    bool playGesture(RSSGesture::Type type, float amplitude = 1.0f, float speed = 1.0f)
+    {
+        if (!_isEnabled)
+        {
+            return false;
+        }
+        bool started = _gesture.start(type, Timer::GetFPGATimestamp(), amplitude, speed);
+        if (started)
+        {
+            DEBUG_RSS_MACHINE_PRINTF("RSSMachine: playGesture: %u\n", static_cast<unsigned>(type));
+        }
+        return started;
+    }
+
+    bool isGestureActive() const
+    {
+        return _gesture.isActive(Timer::GetFPGATimestamp());
+    }
+
+    /*
+        Joystick tilt and the requested height are targets for the motion 
+        planner, and the legs follow the pose it has reached this frame.
+        Once disabled, the neck keeps level while it settles at the lowest
+        height, then the servos are released.
+    */
     std::array<uint16_t, 3> getLegPWMFromJoystick(float x, float y)
     {
+        uint64_t currentTime = Timer::GetFPGATimestamp();
+        if (!_planner.isStarted())
+        {
+            // the neck is left down and level when it is switched off
+            _planner.reset({0.0f, 0.0f, _platformMinHeight}, currentTime);
+        }
         if (!_isEnabled)
         {
-            uint64_t currentTime = Timer::GetFPGATimestamp();
-            if (currentTime - _debounceTimeout < _lastEnabledChange)
-            {
-                x = 0.0f;
-                y = 0.0f;
-            }
-            else
+            _gesture.stop();
+            if (_planner.isSettled() && currentTime - _debounceTimeout >= _lastEnabledChange)
             {
                 return {0, 0, 0};
             }
+            x = 0.0f;
+            y = 0.0f;
         }
         std::tie(x, y) = adjustJoystickToAngleOffset(x, y);
-        std::array<float, 3> legs = getLegAngles(x, y, _platformCurrentHeight);
+        std::tie(x, y) = projectToWorkspace(x, y, _platformCurrentHeight);
+        _planner.setTarget({x, y, _platformCurrentHeight});
+        RSSPose pose = _planner.update(currentTime);
+        // gestures are already smooth curves, so they go on after the planner
+        RSSPose gesture = _gesture.offset(currentTime);
+        pose.nx += gesture.nx;
+        pose.ny += gesture.ny;
+        pose.hz = std::clamp(pose.hz + gesture.hz, _platformMinHeight, _platformMaxHeight);
+        // the reach shrinks towards either end of the height range, so the
+        // tilt on the way there may need to give way
+        std::tie(pose.nx, pose.ny) = projectToWorkspace(pose.nx, pose.ny, pose.hz);
+        _commandedPose = pose;
+
+        if (_legTable.isBuilt())
+        {
+            std::array<float, 3> legs = _legTable.lookup(pose.nx, pose.ny, pose.hz);
+            float lowAngle = std::min(_platformMinHeightAngle, _platformMaxHeightAngle);
+            float highAngle = std::max(_platformMinHeightAngle, _platformMaxHeightAngle);
+            std::array<uint16_t, 3> leg_pwm = {0, 0, 0};
+            for (size_t i = 0; i < legs.size(); ++i)
+            {
+                float pwm = std::clamp(legs[i], angleToPWM(lowAngle) + _servoOffsetPWM[i], angleToPWM(highAngle) + _servoOffsetPWM[i]);
+                leg_pwm[i] = static_cast<uint16_t>(std::lround(pwm));
+            }
+            DEBUG_RSS_MACHINE_PRINTF("A: %4u, B: %4u, C: %4u\n", leg_pwm[0], leg_pwm[1], leg_pwm[2]);
+            return leg_pwm;
+        }
+        std::array<float, 3> legs = getLegAngles(pose.nx, pose.ny, pose.hz);
         std::array<uint16_t, 3> leg_pwm = {0, 0, 0};
         for (size_t i = 0; i < legs.size(); ++i)
         {
-            leg_pwm[i] = mapAngleToPWM(legs[i]) + _servoOffsetPWM[i];
+            leg_pwm[i] = static_cast<uint16_t>(mapAngleToPWM(legs[i]) + _servoOffsetPWM[i]);
         }
         DEBUG_RSS_MACHINE_PRINTF("A: %4u, B: %4u, C: %4u\n", leg_pwm[0], leg_pwm[1], leg_pwm[2]);
         return leg_pwm;
     }
 
+    /*
+        Where the neck is for the leg PWM actually sent, e.g. the positions 
+        the Maestro is animating through.  The last estimate is kept, so
+        asking again for the same PWM costs nothing.
+    */
+    RSSForwardKinematics::Result estimatePose(const std::array<uint16_t, 3> &legPWM)
+    {
+        if (_hasEstimate && legPWM == _estimatedPWM)
+        {
+            return _estimate;
+        }
+        std::array<float, 3> angles;
+        for (size_t i = 0; i < angles.size(); ++i)
+        {
+            angles[i] = pwmToAngle(static_cast<float>(legPWM[i] - _servoOffsetPWM[i]));
+        }
+        _estimate = getPose(angles);
+        _estimatedPWM = legPWM;
+        _hasEstimate = true;
+        DEBUG_RSS_MACHINE_PRINTF("RSSMachine: estimatePose: nx: %4.3f ny: %4.3f hz: %4.2f residual: %4.3f iterations: %u\n",
+            _estimate.pose.nx, _estimate.pose.ny, _estimate.pose.hz, _estimate.residual, _estimate.iterations);
+        return _estimate;
+    }
+
+    // Pose last sent to the legs, after projecting onto the workspace
+    RSSPose commandedPose() const
+    {
+        return _commandedPose;
+    }
+
 protected:
   /// Default input deadband.
   static constexpr float kDefaultDeadband = 0.05f; // 0.125f ?
@@ -220,7 +382,7 @@ protected:
   float m_deadband = kDefaultDeadband;
 
 private:
-    float mapPWMToAngle(uint16_t pulseWidth)
+    float mapPWMToAngle(int32_t pulseWidth)
     {
         // Convert PWM signal to angle
         return static_cast<float>(map(
@@ -232,6 +394,18 @@ private:
         ));
     }
 
+    // Same mapping as mapAngleToPWM() without rounding to whole degrees
+    float angleToPWM(float angle) const
+    {
+        return _servoTheoreticalMinPulse + angle * (_servoTheoreticalMaxPulse - _servoTheoreticalMinPulse) / _servoActuationRange;
+    }
+
+    // Inverse of angleToPWM()
+    float pwmToAngle(float pulseWidth) const
+    {
+        return (pulseWidth - _servoTheoreticalMinPulse) * _servoActuationRange / (_servoTheoreticalMaxPulse - _servoTheoreticalMinPulse);
+    }
+
     uint16_t mapAngleToPWM(float angle)
     {
         // Convert angle to PWM signal
@@ -256,7 +430,8 @@ private:
     uint16_t _servoMinPulse[3] = {0, 0, 0};
     uint16_t _servoMaxPulse[3] = {0, 0, 0};
     float _servoOffsetAngle[3] = {0.0f, 0.0f, 0.0f};
-    uint16_t _servoOffsetPWM[3] = {0, 0, 0};
+    // signed, a leg mounted below the reference pulls its range down
+    int16_t _servoOffsetPWM[3] = {0, 0, 0};
     uint16_t _servoTheoreticalMinPulse = 0;
     uint16_t _servoTheoreticalMaxPulse = 0;
     uint16_t _servoActuationRange = 0;
@@ -268,4 +443,11 @@ private:
     float _rotationRadianOffset = 0.0f;
     float _platformCurrentHeight = 0.0f;
     float _platformPreviousHeight = 0.0f;
+    RSSLegTable _legTable;
+    RSSPosePlanner _planner;
+    RSSGesture _gesture;
+    RSSPose _commandedPose = {0.0f, 0.0f, 0.0f};
+    RSSForwardKinematics::Result _estimate = {};
+    std::array<uint16_t, 3> _estimatedPWM = {0, 0, 0};
+    bool _hasEstimate = false;
 };
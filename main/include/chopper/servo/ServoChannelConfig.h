@@ -0,0 +1,34 @@
+#ifndef CHOPPER_SERVO_SERVOCHANNELCONFIG_H
+#define CHOPPER_SERVO_SERVOCHANNELCONFIG_H
+
+#include <cstdint>
+#include "include/chopper/servo/Easing.h"
+
+/*
+    Static configuration of a single Maestro channel.
+
+    speed and acceleration are in the Maestro's native units:
+        speed:        0.25 μs / 10 ms (0 = unlimited)
+        acceleration: 0.25 μs / 10 ms / 80 ms (0 = unlimited)
+    ref: https://www.pololu.com/docs/0J40/4.b
+
+    idleHold is how long, in milliseconds, the channel keeps driving its 
+    finish position before the PWM signal is stopped.  current is the 
+    estimated draw while powered, in milliamps, counted against the 
+    Maestro's BEC budget.
+*/
+struct ServoChannelConfig
+{
+    uint8_t channel;
+    uint16_t minPulse;
+    uint16_t maxPulse;
+    uint16_t neutralPulse;
+    Easing::Method easing;
+    uint16_t speed;
+    uint16_t acceleration;
+    bool manual;
+    uint16_t idleHold;
+    uint16_t current;
+};
+
+#endif // CHOPPER_SERVO_SERVOCHANNELCONFIG_H
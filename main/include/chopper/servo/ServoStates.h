@@ -0,0 +1,447 @@
+#ifndef CHOPPER_SERVO_SERVOSTATES_H
+#define CHOPPER_SERVO_SERVOSTATES_H
+
+#include <Arduino.h>
+#include <array>
+#include "include/chopper/servo/Easing.h"
+#include "SettingsSystem.h"
+#include "SettingsUser.h"
+#include "include/chopper/Timer.h"
+
+/*
+    Motion state for every channel of a single Maestro.
+
+    State is stored column-wise so the per-tick loop in animate() streams
+    through tightly packed arrays instead of hopping between per-channel 
+    objects.  Times are kept as 32-bit milliseconds relative to the moment 
+    the dispatcher was constructed, which rolls over after ~49 days of uptime.
+*/
+class ServoStates
+{
+public:
+    // Largest Mini Maestro has 24 channels
+    static constexpr uint8_t kMaxChannels = 24;
+    // Maximum rate of change of the output pulse, in μs per second
+    static constexpr uint32_t kSlewRate = 2000;
+    // Shortest replanned move when the servo is still carrying velocity, in ms
+    static constexpr uint32_t kMinRetargetDuration = 50;
+
+    explicit ServoStates(uint8_t channels) :
+        _channels(std::min(channels, kMaxChannels)),
+        _epoch(Timer::GetFPGATimestamp()),
+        _disabledMask(0),
+        _manualMask(0),
+        _retargetMask(0),
+        _pendingMask(0),
+        _powerBudget(UINT32_MAX)
+    {
+        _startPulse.fill(0);
+        _finishPulse.fill(0);
+        _neutralPulse.fill(0);
+        _startPosition.fill(0);
+        _requestedStart.fill(0);
+        _currentPosition.fill(0);
+        _finishPosition.fill(0);
+        _slewPosition.fill(0);
+        _startTime.fill(0);
+        _finishTime.fill(0);
+        _slewTime.fill(0);
+        _sampleTime.fill(0);
+        _movedTime.fill(0);
+        _velocity.fill(0);
+        _startVelocity.fill(0);
+        _easingMethod.fill(Easing::LinearInterpolation);
+        _idleHold.fill(C110P_SERVO_IDLE_HOLD_MS);
+        _current.fill(0);
+        for (uint8_t i = 0; i < _channels; ++i)
+        {
+            _disabledMask |= bit(i);
+        }
+    }
+
+    uint8_t channels() const
+    {
+        return _channels;
+    }
+
+    uint32_t toRelative(uint64_t time) const
+    {
+        return static_cast<uint32_t>(time - _epoch);
+    }
+
+    void setEasingMethod(uint8_t channel, Easing::Method easingMethod)
+    {
+        if (easingMethod == nullptr) {
+            DEBUG_MAESTRO_PRINTF("Easing method is null, using default linear interpolation\n");
+            easingMethod = Easing::LinearInterpolation;
+        }
+        _easingMethod[channel] = easingMethod;
+    }
+
+    void setRange(uint8_t channel, uint16_t startPulse, uint16_t finishPulse, uint16_t neutralPulse)
+    {
+        if (startPulse == 0 || finishPulse == 0) {
+            DEBUG_MAESTRO_PRINTF("Start or finish pulse is zero: %d, %d\n", startPulse, finishPulse);
+            return;
+        }
+        if (startPulse > finishPulse) {
+            DEBUG_MAESTRO_PRINTF("Start pulse is greater than finish pulse: %d, %d\n", startPulse, finishPulse);
+            return;
+        }
+        _startPulse[channel] = startPulse;
+        _finishPulse[channel] = finishPulse;
+        _neutralPulse[channel] = constrain(neutralPulse, startPulse, finishPulse);
+    }
+
+    void setPower(uint8_t channel, uint16_t idleHold, uint16_t current)
+    {
+        _idleHold[channel] = idleHold;
+        _current[channel] = current;
+    }
+
+    void setPowerBudget(uint32_t budget)
+    {
+        _powerBudget = budget;
+    }
+
+    void setEnable(uint8_t channel, bool isEnabled)
+    {
+        _pendingMask &= ~bit(channel);
+        if (isEnabled) {
+            _disabledMask &= ~bit(channel);
+        } else {
+            _disabledMask |= bit(channel);
+        }
+    }
+
+    /*
+        Asks for the channel to be powered.  Manual channels are enabled 
+        immediately, others are admitted on the next animate() once the 
+        power budget allows, and start their move from that tick.
+    */
+    void requestEnable(uint8_t channel)
+    {
+        if (isEnabled(channel)) {
+            return;
+        }
+        if (isManual(channel)) {
+            setEnable(channel, true);
+            return;
+        }
+        _pendingMask |= bit(channel);
+    }
+
+    bool isEnabled(uint8_t channel) const
+    {
+        return !(_disabledMask & bit(channel));
+    }
+
+    void setManual(uint8_t channel, bool isManual)
+    {
+        if (!isManual) {
+            _manualMask &= ~bit(channel);
+            return;
+        }
+        _manualMask |= bit(channel);
+        uint32_t now = toRelative(Timer::GetFPGATimestamp());
+        _startPosition[channel] = _currentPosition[channel];
+        _finishPosition[channel] = _currentPosition[channel];
+        _startTime[channel] = now;
+        _finishTime[channel] = now;
+    }
+
+    bool isManual(uint8_t channel) const
+    {
+        return _manualMask & bit(channel);
+    }
+
+    bool isFinishedMoving(uint8_t channel) const
+    {
+        // signed difference keeps the comparison valid across a rollover
+        int32_t remaining = static_cast<int32_t>(_finishTime[channel] - toRelative(Timer::GetFPGATimestamp()));
+        return (remaining < 0 && _currentPosition[channel] == _finishPosition[channel]);
+    }
+
+    uint16_t getPosition(uint8_t channel) const
+    {
+        return _currentPosition[channel];
+    }
+
+    void setPosition(uint8_t channel, uint16_t position)
+    {
+        if (position == 0) {
+            // this effectively disables the servo, manual controls may want to do this
+            _currentPosition[channel] = 0;
+            return;
+        }
+        _currentPosition[channel] = constrain(position, _startPulse[channel], _finishPulse[channel]);
+        _slewPosition[channel] = _currentPosition[channel];
+    }
+
+    void setAngle(uint8_t channel, float angle, uint16_t actuationRange, uint16_t minPulse, uint16_t maxPulse)
+    {
+        if (isnan(angle) || isinf(angle) || angle < 0.0f || angle > static_cast<float>(actuationRange)) {
+            DEBUG_MAESTRO_PRINTF("Angle out of range: %.2f\n", angle);
+            return;
+        }
+        // Convert angle to pulse width
+        uint16_t pulseWidth = map(
+            static_cast<uint16_t>(round(angle)), 
+            0, 
+            actuationRange, 
+            minPulse,       // theoretical min pulse width
+            maxPulse);      // theoretical max pulse width
+        DEBUG_MAESTRO_PRINTF("Angle: %.2f, Pulse Width: %d\n", angle, pulseWidth);
+        setPosition(channel, pulseWidth);
+    }
+
+    /*
+        Plans a move from startPosition to finishPosition over 
+        [startTime, finishTime].
+
+        If the channel is already somewhere other than startPosition (e.g. 
+        a move was interrupted part way), the remaining motion is replanned 
+        from the current position and velocity with a cubic Hermite curve, 
+        so the servo neither jumps nor reverses abruptly.  The duration is 
+        scaled by the fraction of the full range still left to travel, unless
+        scaleDuration is false, in which case the move finishes exactly at 
+        finishTime (used by ServoSyncGroup to line channels up).
+    */
+    void setTargets(uint8_t channel, uint16_t startPosition, uint16_t finishPosition, uint64_t startTime, uint64_t finishTime, bool scaleDuration = true)
+    {
+        if (startPosition == _requestedStart[channel] && finishPosition == _finishPosition[channel])
+        {
+            // duplicate call to something already in motion, no need to reassign
+            return;
+        }
+        if (startPosition == 0 || finishPosition == 0)
+        {
+            DEBUG_MAESTRO_PRINTF("Start or finish position is zero: %d, %d\n", startPosition, finishPosition);
+            return;
+        }
+        if (startTime > finishTime) {
+            DEBUG_MAESTRO_PRINTF("Start time is greater than finish time: %llu, %llu\n", startTime, finishTime);
+            return;
+        }
+        uint16_t start = constrain(startPosition, _startPulse[channel], _finishPulse[channel]);
+        uint16_t finish = constrain(finishPosition, _startPulse[channel], _finishPulse[channel]);
+        uint16_t current = _currentPosition[channel];
+        uint32_t relativeStart = toRelative(startTime);
+        uint32_t duration = static_cast<uint32_t>(finishTime - startTime);
+        _requestedStart[channel] = start;
+        _finishPosition[channel] = finish;
+        _startTime[channel] = relativeStart;
+
+        if (current == 0 || current == start || start == finish)
+        {
+            // starting from rest at the requested position, follow the easing method
+            _retargetMask &= ~bit(channel);
+            _startPosition[channel] = start;
+            _finishTime[channel] = relativeStart + duration;
+        }
+        else
+        {
+            // already in motion, continue from where the servo actually is
+            float remaining = fabs(static_cast<float>(finish - current) / (finish - start));
+            uint32_t remainingDuration = duration;
+            if (scaleDuration)
+            {
+                remainingDuration = static_cast<uint32_t>(std::min(remaining, 1.0f) * duration);
+            }
+            if (scaleDuration && _velocity[channel] != 0)
+            {
+                remainingDuration = std::max(remainingDuration, kMinRetargetDuration);
+            }
+            _retargetMask |= bit(channel);
+            _startPosition[channel] = current;
+            _startVelocity[channel] = _velocity[channel];
+            _finishTime[channel] = relativeStart + remainingDuration;
+        }
+        DEBUG_MAESTRO_PRINTF("start: %d, finish: %d, current: %d, velocity: %d, startTime: %u, finishTime: %u\n", 
+            _startPosition[channel],
+            finish,
+            current,
+            _velocity[channel],
+            _startTime[channel],
+            _finishTime[channel]);
+    }
+
+    /*
+        Advances every channel to currentTime and writes the next pulse for 
+        each into targets, in 1/4 μs units as expected by setMultiTarget.  
+        Disabled channels are written as 0.
+    */
+    void animate(uint64_t currentTime, uint16_t *targets)
+    {
+        uint32_t now = toRelative(currentTime);
+        updatePower(now);
+        for (uint8_t i = 0; i < _channels; ++i)
+        {
+            targets[i] = getNextPulse(i, now) * 4;
+        }
+    }
+
+private:
+    /*
+        Powers down channels which have held their finish position for their
+        idle hold time, then admits pending channels in order while the 
+        estimated draw stays within the power budget.  Manual channels are 
+        never powered down here.
+    */
+    void updatePower(uint32_t now)
+    {
+        uint32_t load = 0;
+        for (uint8_t i = 0; i < _channels; ++i)
+        {
+            if (_disabledMask & bit(i))
+            {
+                continue;
+            }
+            // hold time counts from when the servo actually settled, which the
+            // slew limit can push past the planned finish time
+            int32_t sinceFinish = static_cast<int32_t>(now - _finishTime[i]);
+            int32_t sinceMoved = static_cast<int32_t>(now - _movedTime[i]);
+            if (!(_manualMask & bit(i)) && sinceFinish >= 0 && sinceMoved >= _idleHold[i] && _currentPosition[i] == _finishPosition[i])
+            {
+                DEBUG_MAESTRO_PRINTF("Servo %d idle, powering down\n", i);
+                _disabledMask |= bit(i);
+                continue;
+            }
+            load += _current[i];
+        }
+        for (uint8_t i = 0; i < _channels && _pendingMask != 0; ++i)
+        {
+            if (!(_pendingMask & bit(i)))
+            {
+                continue;
+            }
+            if (load != 0 && load + _current[i] > _powerBudget)
+            {
+                // deferred, try again next tick
+                continue;
+            }
+            load += _current[i];
+            _pendingMask &= ~bit(i);
+            _disabledMask &= ~bit(i);
+            // start the move from the tick it was powered
+            int32_t late = static_cast<int32_t>(now - _startTime[i]);
+            if (late > 0)
+            {
+                _startTime[i] += late;
+                _finishTime[i] += late;
+            }
+        }
+    }
+
+    uint16_t getNextPulse(uint8_t channel, uint32_t now)
+    {
+        if (_disabledMask & bit(channel))
+        {
+            _velocity[channel] = 0;
+            return 0;
+        }
+        else if (_manualMask & bit(channel))
+        {
+            _velocity[channel] = 0;
+            return _currentPosition[channel];
+        }
+        uint16_t previousPosition = _currentPosition[channel];
+        uint16_t newPosition = previousPosition;
+        int32_t elapsedDuration = static_cast<int32_t>(now - _startTime[channel]);
+        uint32_t totalDuration = _finishTime[channel] - _startTime[channel];
+        if (elapsedDuration >= 0 && static_cast<uint32_t>(elapsedDuration) < totalDuration)
+        {
+            // Update the target position based on the time elapsed
+            float progress = static_cast<float>(elapsedDuration) / totalDuration;
+            int32_t distance = _finishPosition[channel] - _startPosition[channel];
+            int32_t distanceToMove;
+            if (_retargetMask & bit(channel))
+            {
+                distanceToMove = hermite(progress, distance, _startVelocity[channel] * static_cast<float>(totalDuration) / 1000.0f);
+            }
+            else
+            {
+                distanceToMove = distance * _easingMethod[channel](progress);
+            }
+            newPosition = slew(channel, now, constrain(_startPosition[channel] + distanceToMove, _startPulse[channel], _finishPulse[channel]));
+        }
+        else if (elapsedDuration >= 0)
+        {
+            // If the time is past the finish time, set the position to the finish position
+            newPosition = slew(channel, now, _finishPosition[channel]);
+        }
+        if (newPosition != previousPosition)
+        {
+            _movedTime[channel] = now;
+        }
+        uint32_t sampleDuration = now - _sampleTime[channel];
+        if (sampleDuration > 0)
+        {
+            int32_t velocity = (static_cast<int32_t>(newPosition) - previousPosition) * 1000 / static_cast<int32_t>(std::min<uint32_t>(sampleDuration, UINT16_MAX));
+            _velocity[channel] = constrain(velocity, INT16_MIN, INT16_MAX);
+            _sampleTime[channel] = now;
+        }
+        _currentPosition[channel] = newPosition;
+        return newPosition;
+    }
+
+    /*
+        Cubic Hermite from the start of a replanned move (offset 0, velocity 
+        startVelocity scaled to the move duration) to distance at rest.
+    */
+    static float hermite(float progress, float distance, float startVelocity)
+    {
+        float s2 = progress * progress;
+        float s3 = s2 * progress;
+        return distance * (3.0f * s2 - 2.0f * s3) + startVelocity * (s3 - 2.0f * s2 + progress);
+    }
+
+    uint16_t slew(uint8_t channel, uint32_t now, uint16_t target)
+    {
+        // cap the elapsed time so the multiply below cannot overflow after a long idle
+        uint32_t elapsed = std::min<uint32_t>(now - _slewTime[channel], UINT16_MAX);
+        int32_t maxStep = static_cast<int32_t>(kSlewRate * elapsed / 1000);
+        if (maxStep == 0)
+        {
+            // leave the timestamp alone so short ticks accumulate into a step
+            return _slewPosition[channel];
+        }
+        int32_t step = std::clamp(static_cast<int32_t>(target) - _slewPosition[channel], -maxStep, maxStep);
+        _slewPosition[channel] += step;
+        _slewTime[channel] = now;
+        return _slewPosition[channel];
+    }
+
+    uint8_t _channels;
+    uint64_t _epoch;
+    uint32_t _disabledMask;
+    uint32_t _manualMask;
+    uint32_t _retargetMask;
+    uint32_t _pendingMask;
+    // milliamps
+    uint32_t _powerBudget;
+    std::array<uint16_t, kMaxChannels> _startPulse;
+    std::array<uint16_t, kMaxChannels> _finishPulse;
+    std::array<uint16_t, kMaxChannels> _neutralPulse;
+    std::array<uint16_t, kMaxChannels> _startPosition;
+    std::array<uint16_t, kMaxChannels> _requestedStart;
+    std::array<uint16_t, kMaxChannels> _currentPosition;
+    std::array<uint16_t, kMaxChannels> _finishPosition;
+    std::array<uint16_t, kMaxChannels> _slewPosition;
+    std::array<uint32_t, kMaxChannels> _startTime;
+    std::array<uint32_t, kMaxChannels> _finishTime;
+    std::array<uint32_t, kMaxChannels> _slewTime;
+    std::array<uint32_t, kMaxChannels> _sampleTime;
+    std::array<uint32_t, kMaxChannels> _movedTime;
+    // μs per second, measured from the pulses actually sent
+    std::array<int16_t, kMaxChannels> _velocity;
+    std::array<int16_t, kMaxChannels> _startVelocity;
+    std::array<Easing::Method, kMaxChannels> _easingMethod;
+    std::array<uint16_t, kMaxChannels> _idleHold;
+    std::array<uint16_t, kMaxChannels> _current;
+
+    static_assert(kMaxChannels <= 32, "channel flags are packed into a uint32_t");
+};
+
+
+#endif // CHOPPER_SERVO_SERVOSTATES_H
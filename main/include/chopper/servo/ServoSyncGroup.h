@@ -0,0 +1,131 @@
+#ifndef CHOPPER_SERVO_SERVOSYNCGROUP_H
+#define CHOPPER_SERVO_SERVOSYNCGROUP_H
+
+#include <array>
+#include <functional>
+#include <initializer_list>
+#include "include/chopper/servo/Dispatch.h"
+#include "include/chopper/Timer.h"
+
+struct ServoSyncTarget
+{
+    ServoDispatch *dispatch;
+    uint8_t channel;
+    uint16_t startPosition;
+    uint16_t finishPosition;
+};
+
+/*
+    Plans a set of channels, on one or more ServoDispatch, as a single move.
+
+    Every member starts on the same tick and finishes on the same tick.  The
+    shared duration is stretched to the member with the furthest left to 
+    travel, so a group interrupted part way still lands together.  When all
+    members have arrived the completion callback fires exactly once.
+
+    Members held back by a Maestro's power budget start late, so keep groups
+    within the BEC budget of the Maestros they span.
+*/
+class ServoSyncGroup
+{
+public:
+    static constexpr uint8_t kMaxMembers = 8;
+
+    ServoSyncGroup() = default;
+    ~ServoSyncGroup() = default;
+
+    /*
+        Starts a coordinated move.  A group accepts one plan per trigger time,
+        so calling this every frame while a button is held is safe.
+
+        @return true if a new move was planned
+    */
+    bool start(std::initializer_list<ServoSyncTarget> targets, uint64_t startTime, uint32_t duration, std::function<void()> onComplete = nullptr)
+    {
+        if (startTime == _startTime)
+        {
+            return false;
+        }
+        if (targets.size() > kMaxMembers)
+        {
+            DEBUG_MAESTRO_PRINTF("Sync group has too many members: %u\n", static_cast<unsigned>(targets.size()));
+            return false;
+        }
+
+        // stretch the move to whichever member has the furthest left to go
+        float furthest = 0.0f;
+        _count = 0;
+        for (const ServoSyncTarget &target : targets)
+        {
+            _members[_count++] = target;
+            furthest = std::max(furthest, remainingFraction(target));
+        }
+        uint32_t sharedDuration = std::max<uint32_t>(static_cast<uint32_t>(furthest * duration), 1);
+
+        for (uint8_t i = 0; i < _count; ++i)
+        {
+            const ServoSyncTarget &member = _members[i];
+            member.dispatch->setTimedMovement(member.channel, member.startPosition, member.finishPosition, startTime, sharedDuration, false);
+        }
+        _startTime = startTime;
+        _finishTime = startTime + sharedDuration;
+        _onComplete = onComplete;
+        _isActive = true;
+        DEBUG_MAESTRO_PRINTF("Sync group of %d planned for %u ms\n", _count, sharedDuration);
+        return true;
+    }
+
+    /*
+        Fires the completion callback once every member has arrived.  Call 
+        once per frame after the dispatchers have animated.
+    */
+    void update()
+    {
+        if (!_isActive || Timer::GetFPGATimestamp() < _finishTime)
+        {
+            return;
+        }
+        for (uint8_t i = 0; i < _count; ++i)
+        {
+            if (!_members[i].dispatch->isFinishedMoving(_members[i].channel))
+            {
+                return;
+            }
+        }
+        _isActive = false;
+        if (_onComplete)
+        {
+            _onComplete();
+        }
+    }
+
+    bool isActive() const
+    {
+        return _isActive;
+    }
+
+private:
+    static float remainingFraction(const ServoSyncTarget &target)
+    {
+        uint16_t current = target.dispatch->getPosition(target.channel);
+        if (target.startPosition == target.finishPosition)
+        {
+            return 0.0f;
+        }
+        if (current == 0 || current == target.startPosition)
+        {
+            return 1.0f;
+        }
+        float remaining = fabs(static_cast<float>(target.finishPosition - current) / (target.finishPosition - target.startPosition));
+        return std::min(remaining, 1.0f);
+    }
+
+    std::array<ServoSyncTarget, kMaxMembers> _members;
+    uint8_t _count = 0;
+    uint64_t _startTime = 0;
+    uint64_t _finishTime = 0;
+    bool _isActive = false;
+    std::function<void()> _onComplete;
+};
+
+#endif // CHOPPER_SERVO_SERVOSYNCGROUP_H
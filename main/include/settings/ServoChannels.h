@@ -0,0 +1,83 @@
+#ifndef __SERVO_CHANNELS_H__
+#define __SERVO_CHANNELS_H__
+
+#include "include/chopper/servo/ServoChannelConfig.h"
+#include "include/settings/ServoPinMap.h"
+#include "include/settings/ServoPWM.h"
+
+/*
+    Channel map for each Maestro, channels not listed here are left unconfigured.
+
+    { channel, min, max, neutral, easing, speed, accel, manual, idle hold, current }
+*/
+constexpr ServoChannelConfig kMaestroBodyChannels[] = {
+    {
+        MAESTRO_BODY_NECK_A,
+        MAESTRO_BODY_NECK_A_MIN, MAESTRO_BODY_NECK_A_MAX, MAESTRO_BODY_NECK_A_NEUTRAL,
+        nullptr,
+        MAESTRO_BODY_NECK_A_SPEED, MAESTRO_BODY_NECK_A_ACCEL,
+        MAESTRO_BODY_NECK_A_MANUAL,
+        0, MAESTRO_BODY_NECK_A_CURRENT
+    },
+    {
+        MAESTRO_BODY_NECK_B,
+        MAESTRO_BODY_NECK_B_MIN, MAESTRO_BODY_NECK_B_MAX, MAESTRO_BODY_NECK_B_NEUTRAL,
+        nullptr,
+        MAESTRO_BODY_NECK_B_SPEED, MAESTRO_BODY_NECK_B_ACCEL,
+        MAESTRO_BODY_NECK_B_MANUAL,
+        0, MAESTRO_BODY_NECK_B_CURRENT
+    },
+    {
+        MAESTRO_BODY_NECK_C,
+        MAESTRO_BODY_NECK_C_MIN, MAESTRO_BODY_NECK_C_MAX, MAESTRO_BODY_NECK_C_NEUTRAL,
+        nullptr,
+        MAESTRO_BODY_NECK_C_SPEED, MAESTRO_BODY_NECK_C_ACCEL,
+        MAESTRO_BODY_NECK_C_MANUAL,
+        0, MAESTRO_BODY_NECK_C_CURRENT
+    },
+    {
+        MAESTRO_UTILITY_ARM,
+        MAESTRO_UTILITY_ARM_MIN, MAESTRO_UTILITY_ARM_MAX, MAESTRO_UTILITY_ARM_NEUTRAL,
+        MAESTRO_UTILITY_ARM_EASING,
+        MAESTRO_UTILITY_ARM_SPEED, MAESTRO_UTILITY_ARM_ACCEL,
+        false,
+        MAESTRO_UTILITY_ARM_IDLE_HOLD, MAESTRO_UTILITY_ARM_CURRENT
+    },
+};
+
+constexpr ServoChannelConfig kMaestroDomeChannels[] = {
+    {
+        MAESTRO_DOME_PERISCOPE_LIFT,
+        MAESTRO_DOME_PERISCOPE_LIFT_MIN, MAESTRO_DOME_PERISCOPE_LIFT_MAX, MAESTRO_DOME_PERISCOPE_LIFT_NEUTRAL,
+        MAESTRO_DOME_PERISCOPE_LIFT_EASING,
+        MAESTRO_DOME_PERISCOPE_LIFT_SPEED, MAESTRO_DOME_PERISCOPE_LIFT_ACCEL,
+        false,
+        MAESTRO_DOME_PERISCOPE_LIFT_IDLE_HOLD, MAESTRO_DOME_PERISCOPE_LIFT_CURRENT
+    },
+    {
+        MAESTRO_DOME_PERISCOPE_SPIN,
+        MAESTRO_DOME_PERISCOPE_SPIN_MIN, MAESTRO_DOME_PERISCOPE_SPIN_MAX, MAESTRO_DOME_PERISCOPE_SPIN_NEUTRAL,
+        MAESTRO_DOME_PERISCOPE_SPIN_EASING,
+        MAESTRO_DOME_PERISCOPE_SPIN_SPEED, MAESTRO_DOME_PERISCOPE_SPIN_ACCEL,
+        false,
+        MAESTRO_DOME_PERISCOPE_SPIN_IDLE_HOLD, MAESTRO_DOME_PERISCOPE_SPIN_CURRENT
+    },
+    {
+        MAESTRO_DOME_DOOR_LEFT,
+        MAESTRO_DOME_DOOR_LEFT_MIN, MAESTRO_DOME_DOOR_LEFT_MAX, MAESTRO_DOME_DOOR_LEFT_NEUTRAL,
+        MAESTRO_DOME_DOOR_LEFT_EASING,
+        MAESTRO_DOME_DOOR_LEFT_SPEED, MAESTRO_DOME_DOOR_LEFT_ACCEL,
+        false,
+        MAESTRO_DOME_DOOR_LEFT_IDLE_HOLD, MAESTRO_DOME_DOOR_LEFT_CURRENT
+    },
+    {
+        MAESTRO_DOME_DOOR_RIGHT,
+        MAESTRO_DOME_DOOR_RIGHT_MIN, MAESTRO_DOME_DOOR_RIGHT_MAX, MAESTRO_DOME_DOOR_RIGHT_NEUTRAL,
+        MAESTRO_DOME_DOOR_RIGHT_EASING,
+        MAESTRO_DOME_DOOR_RIGHT_SPEED, MAESTRO_DOME_DOOR_RIGHT_ACCEL,
+        false,
+        MAESTRO_DOME_DOOR_RIGHT_IDLE_HOLD, MAESTRO_DOME_DOOR_RIGHT_CURRENT
+    },
+};
+
+#endif // __SERVO_CHANNELS_H__
@@ -7,6 +7,8 @@
 #include <Arduino.h>
 #include <Bluepad32.h>
 #include <Preferences.h>
+#include <esp_console.h>
+#include <cstring>
 #include "include/PinMap.h"
 #include "include/SettingsSystem.h"
 #include "include/SettingsUser.h"
@@ -47,15 +49,20 @@ DomePosition domeSensor = DomePosition(domeAnalogProvider);
 #include <SoftwareSerial.h>
 #include "chopper/drive/SabertoothDrive.h"
 
+// Both drivers share one TX line, commands are queued and sent once per loop
+#include "chopper/serial/SerialBusArbiter.h"
+static_assert(C110P_MOTOR_BUS_BYTES_PER_FRAME >= 4, "SABERTOOTH_SERIAL_BAUD_RATE is too slow to send a motor command every LOOP_PERIOD_MS");
+SerialBusArbiter sabertoothBus(UART_SABERTOOTH, C110P_MOTOR_BUS_BYTES_PER_FRAME);
+
 // Setup Sabertooth Driver for Feet
 #include "chopper/drive/DifferentialDriveSabertooth.h"
 SabertoothDrive sabertoothDiffDrive(SABERTOOTH_TANK_DRIVE_ID, UART_SABERTOOTH, 2);
-DifferentialDrive sabertoothDiff(sabertoothDiffDrive.GetMotor(1), sabertoothDiffDrive.GetMotor(2));
+DifferentialDriveSabertooth sabertoothDiff(sabertoothDiffDrive);
 
 // Setup SyRen Driver for Dome
 #include "chopper/drive/SingleDriveSabertooth.h"
 SabertoothDrive sabertoothSyRenDrive(SABERTOOTH_DOME_DRIVE_ID, UART_SABERTOOTH, 1); 
-SingleDrive sabertoothSyRen(sabertoothSyRenDrive.GetMotor(1));
+SingleDriveSabertooth sabertoothSyRen(sabertoothSyRenDrive);
 
 /*
     Maestro Configuration
@@ -64,8 +71,11 @@ SingleDrive sabertoothSyRen(sabertoothSyRenDrive.GetMotor(1));
 
 // RX and TX on pin from PINOUT.h connected to opposite TX/RX on Maestro board
 // ref: https://www.pololu.com/docs/0J40/5.g
-ServoDispatch maestroBody(UART_MAESTRO_BODY, Maestro::noResetPin, MAESTRO_BODY_ID, false, MAESTRO_BODY_CHANNELS);
-ServoDispatch maestroDome(UART_MAESTRO_DOME, Maestro::noResetPin, MAESTRO_DOME_ID, false, MAESTRO_DOME_CHANNELS);
+// Both Maestros share one UART, each addressed by its device number
+#include "chopper/serial/PololuBus.h"
+PololuBus maestroBus(UART_MAESTRO);
+ServoDispatch maestroBody(maestroBus.addPort(), Maestro::noResetPin, MAESTRO_BODY_ID, C110P_SERVO_CRC_ENABLED, MAESTRO_BODY_CHANNELS);
+ServoDispatch maestroDome(maestroBus.addPort(), Maestro::noResetPin, MAESTRO_DOME_ID, C110P_SERVO_CRC_ENABLED, MAESTRO_DOME_CHANNELS);
 
 /*
     RSS Machine Configuration
@@ -147,8 +157,6 @@ void setupSabertooth() {
     // Sabertooth object.
     Sabertooth::autobaud(UART_SABERTOOTH);
 
-    UART_SABERTOOTH.setTimeout(C110P_MOTOR_SERIAL_TIMEOUT_MS);
-
     // This setting does not persist between power cycles.
     // See the Packet Serial section of the documentation for what values to use
     // for the minimum voltage command. It may vary between Sabertooth models
@@ -160,20 +168,27 @@ void setupSabertooth() {
 
     // Setup the Drive motors
     sabertoothDiff.SetSpeedLimit(C110P_DRIVE_MAXIMUM_SPEED);
+    sabertoothDiff.SetStopRamp(C110P_MOTOR_SAFETY_RAMP_MS, [] { sabertoothBus.flush(); });
     sabertoothDiff.SetSafetyEnabled(C110P_MOTOR_SAFETY);
     sabertoothDiff.SetExpiration(C110P_MOTOR_SAFETY_TIMEOUT_MS);
-    sabertoothDiff.SetRampingValue(C110P_DRIVE_RAMPING_PERIOD);
     sabertoothDiff.SetDeadband(C110P_DRIVE_DEADBAND);
     sabertoothDiffDrive.GetMotor(1).SetInverted(C110P_DRIVE_MOTOR_1_INVERTED);
     sabertoothDiffDrive.GetMotor(2).SetInverted(C110P_DRIVE_MOTOR_2_INVERTED);
+    sabertoothDiffDrive.SetMixedMode(C110P_DRIVE_MIXED_MODE);
+    sabertoothDiffDrive.SetArbiter(&sabertoothBus, SerialBusArbiter::Priority::Drive);
+    sabertoothDiff.SetRampingValue(C110P_DRIVE_RAMPING_PERIOD);
+    sabertoothDiff.SetSerialTimeout(C110P_MOTOR_SERIAL_TIMEOUT_MS);
     
     // Setup the Dome motor
     sabertoothSyRen.SetSpeedLimit(C110P_DOME_MAXIMUM_SPEED);
+    sabertoothSyRen.SetStopRamp(C110P_MOTOR_SAFETY_RAMP_MS, [] { sabertoothBus.flush(); });
     sabertoothSyRen.SetSafetyEnabled(C110P_MOTOR_SAFETY);
     sabertoothSyRen.SetExpiration(C110P_MOTOR_SAFETY_TIMEOUT_MS);
-    sabertoothSyRen.SetRampingValue(C110P_DOME_RAMPING_PERIOD);
     sabertoothSyRen.SetDeadband(C110P_DOME_DEADBAND);
     sabertoothSyRenDrive.GetMotor(1).SetInverted(C110P_DOME_MOTOR_1_INVERTED);
+    sabertoothSyRenDrive.SetArbiter(&sabertoothBus, SerialBusArbiter::Priority::Dome);
+    sabertoothSyRen.SetRampingValue(C110P_DOME_RAMPING_PERIOD);
+    sabertoothSyRen.SetSerialTimeout(C110P_MOTOR_SERIAL_TIMEOUT_MS);
 
     // See the Packet Serial section of the documentation for what values to use
     // for the maximum voltage command. It may vary between Sabertooth models
@@ -191,31 +206,55 @@ void setupSabertooth() {
     // WARNING: This setting persists between power cycles.
     // ST.setMaxVoltage(71);
 
-    // See the Sabertooth 2x60 documentation for information on ramping values.
-    // There are three ranges: 1-10 (Fast), 11-20 (Slow), and 21-80 (Intermediate).
-    // The ramping value 14 used here sets a ramp time of 4 seconds for full
-    // forward-to-full reverse.
-    //
-    // 0 turns off ramping. Turning off ramping requires a power cycle.
+    // Ramping is programmed above from C110P_DRIVE_RAMPING_PERIOD and
+    // C110P_DOME_RAMPING_PERIOD, see the Sabertooth 2x60 documentation for the values.
     //
-    // WARNING: The Sabertooth remembers this command between restarts AND in all modes.
-    // To change your Sabertooth back to its default, call ST.setRamping(0)
-    // ST.setRamping(14);
+    // WARNING: The Sabertooth remembers ramping between restarts AND in all modes.
+    // Set the period to 0 to change it back to its default.
 
 }
 
 void setupMaestro() {
     // Set the serial baud rate.
-    UART_MAESTRO_BODY_INIT(MAESTRO_SERIAL_BAUD_RATE);
-    UART_MAESTRO_DOME_INIT(MAESTRO_SERIAL_BAUD_RATE);
+    UART_MAESTRO_INIT(MAESTRO_SERIAL_BAUD_RATE);
+
+    // Step the link up to the fastest rate the Maestros answer on
+    static constexpr uint32_t baudRates[] = MAESTRO_SERIAL_BAUD_RATES;
+    uint32_t baudRate = ServoDispatch::negotiateBaud({&maestroBody, &maestroDome}, baudRates, [](uint32_t rate) {
+        UART_MAESTRO.flush();
+        UART_MAESTRO.updateBaudRate(rate);
+    });
+    if (baudRate == 0)
+    {
+        // a Maestro in detect baud mode that heard the first attempt is locked
+        // to the fastest rate, so fall back to that rather than a slower one
+        baudRate = baudRates[0];
+        Console.printf("Maestros are not answering, staying at %u baud\n", static_cast<unsigned>(baudRate));
+        UART_MAESTRO.flush();
+        UART_MAESTRO.updateBaudRate(baudRate);
+    }
+    else
+    {
+        for (ServoDispatch *maestro : {&maestroBody, &maestroDome})
+        {
+            if (!maestro->isAnswering())
+            {
+                Console.printf("Maestro %u is not answering at %u baud\n", maestro->deviceNumber(), static_cast<unsigned>(baudRate));
+            }
+        }
+    }
+
+    // A compact command is acted on by every device on the line
+    maestroBody.setCompactProtocol(maestroBus.portCount() == 1);
+    maestroDome.setCompactProtocol(maestroBus.portCount() == 1);
     // TODO: should all servers return to their home poistion on startup?
 
     // ref: https://github.com/plerup/espsoftwareserial/blob/main/README.md
     // set timeout for get commands which wait for 4 bytes of data 
     // maestro-arduio library only blocks for 2 bytes, but we double to 4 it to be safe
     // assume 8 bit, even parity, 2 stop bits = 11 bits per byte (worst case)
-    uint16_t timeout = ceil(4.0f / ceil(static_cast<float>((MAESTRO_SERIAL_BAUD_RATE) / 11.0f / 1000.0f)));
-    DEBUG_MAESTRO_PRINTF("Maestro timeout: %u %u %u\n", timeout, MAESTRO_SERIAL_BAUD_RATE, ceil(MAESTRO_SERIAL_BAUD_RATE / 11 / 1000));
+    uint16_t timeout = ceil(4.0f / ceil(static_cast<float>(baudRate) / 11.0f / 1000.0f));
+    DEBUG_MAESTRO_PRINTF("Maestro timeout: %u %u\n", timeout, static_cast<unsigned>(baudRate));
 
     // Ensure timeout is less than CONFIG_ESP_TASK_WDT_TIMEOUT_S by at least 100
     if (timeout >= CONFIG_ESP_TASK_WDT_TIMEOUT_S * 1000 - 100) {
@@ -226,9 +265,14 @@ void setupMaestro() {
     maestroBody.setTimeout(timeout);
     maestroDome.setTimeout(timeout);
 
+    // Program channel speed and acceleration now that the ports are up
+    maestroBody.begin();
+    maestroDome.begin();
+
     // Disable PWM signals to servos
     maestroBody.disableAll();
     maestroDome.disableAll();
+    maestroBus.flush();
 }
 
 void setupMp3Trigger() {
@@ -244,6 +288,8 @@ void setupRssMachine()
     rssMachine.setActuationRange(C110P_RSS_MECHANISM_ACTUATION_RANGE);
     rssMachine.setLegMinPulse(MAESTRO_BODY_NECK_A_MIN, MAESTRO_BODY_NECK_B_MIN, MAESTRO_BODY_NECK_C_MIN);
     rssMachine.setLegMaxPulse(MAESTRO_BODY_NECK_A_MAX, MAESTRO_BODY_NECK_B_MAX, MAESTRO_BODY_NECK_C_MAX);
+    rssMachine.buildWorkspace();
+    rssMachine.buildLegTable();
     rssMachine.printSettings();
     maestroBody.enable(MAESTRO_BODY_NECK_A);
     maestroBody.enable(MAESTRO_BODY_NECK_B);
@@ -264,6 +310,29 @@ void setupLeds() {
     digitalWrite(PIN_LED_BACK, LOW);
 }
 
+// "motor_safety" on the Bluepad32 console prints the watchdog statistics,
+// "motor_safety reset" clears them
+int consoleMotorSafety(int argc, char** argv) {
+    if (argc > 1 && strcmp(argv[1], "reset") == 0) {
+        MotorSafety::ResetAllStats();
+        Console.printf("MotorSafety statistics cleared\n");
+        return 0;
+    }
+    MotorSafety::PrintAllStats();
+    return 0;
+}
+
+void setupConsole() {
+    esp_console_cmd_t motorSafety = {};
+    motorSafety.command = "motor_safety";
+    motorSafety.help = "Print the motor safety watchdog statistics, or clear them with 'reset'";
+    motorSafety.hint = "[reset]";
+    motorSafety.func = &consoleMotorSafety;
+    if (esp_console_cmd_register(&motorSafety) != ESP_OK) {
+        Console.printf("Could not register the motor_safety console command\n");
+    }
+}
+
 // Arduino setup function. Runs in CPU 1
 void setup() {
     // Set system clock to 0
@@ -277,6 +346,7 @@ void setup() {
     setupRssMachine();
     setupOpenMV();
     setupLeds();
+    setupConsole();
 }
 
 uint8_t brightness = 0;  // how bright the LED is
@@ -290,6 +360,11 @@ void loop() {
     {
         myControllers.processInputs();
     }
+    // every loop, so servo moves, the idle power-down and a stop from
+    // MotorSafety all go out even without new input
+    myControllers.update();
+    sabertoothBus.flush();
+    maestroBus.flush();
 
     brightness = brightness + fadeAmount;
     if (brightness <= 0 || brightness >= 255) {
@@ -304,5 +379,5 @@ void loop() {
     //     vTaskDelay(1);
     analogWrite(PIN_LED_FRONT, brightness);
     // delay(150);
-    vTaskDelay(pdMS_TO_TICKS(10));
+    vTaskDelay(pdMS_TO_TICKS(LOOP_PERIOD_MS));
 }
\ No newline at end of file
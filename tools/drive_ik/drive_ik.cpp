@@ -0,0 +1,168 @@
+/*
+    Host check of the drive IK tables against the functions they replace.
+
+    Builds the same three tables as DifferentialDrive.cpp and compares
+    them with ArcadeDriveIK(), CurvatureDriveIK() and ReelTwoDriveIK():
+      - every one of the 255x255 stick positions the Sabertooth can tell 
+        apart must give the same wheel steps as the function,
+      - over random float sticks the table may only differ by what 
+        quantizing costs: half a step rounding the wheel command, plus 
+        half a step on each stick axis times the steepest slope of the 
+        function (the largest sum of |d/dx| and |d/dz|, found on a fine
+        grid).
+    The squared ReelTwo table is also checked against the trig form of
+    ReelTwo it replaced, and the unsquared ReelTwo against the turn in 
+    place table it shares.
+
+    Exits non-zero if any check fails.
+
+    usage: drive_ik [--samples N]
+*/
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <random>
+
+#include "chopper/drive/DifferentialDrive.h"
+#include "chopper/drive/DriveIKTable.h"
+
+namespace
+{
+
+using WheelSpeeds = DifferentialDrive::WheelSpeeds;
+using IKTable = DriveIKTable<WheelSpeeds>;
+using Kernel = std::function<WheelSpeeds(float xSpeed, float zRotation)>;
+
+// stick spacing of the slope search, and the half width of its differences
+constexpr int kSlopeGrid = 1000;
+constexpr float kSlopeStep = 1e-3f;
+
+// as in DifferentialDrive.cpp
+constexpr IKTable kArcadeSquaredTable{[](float xSpeed, float zRotation) {
+    return DifferentialDrive::ArcadeDriveIK(xSpeed, zRotation, true);
+}};
+constexpr IKTable kTurnInPlaceTable{[](float xSpeed, float zRotation) {
+    return DifferentialDrive::CurvatureDriveIK(xSpeed, zRotation, true);
+}};
+constexpr IKTable kReelTwoSquaredTable{[](float xSpeed, float zRotation) {
+    return DifferentialDrive::ReelTwoDriveIK(xSpeed, zRotation, true);
+}};
+
+// ReelTwo as it was before the closed form: rotate the stick by 45 degrees
+WheelSpeeds reelTwoTrig(float xSpeed, float zRotation)
+{
+    xSpeed = std::clamp(xSpeed, -1.0f, 1.0f);
+    zRotation = std::clamp(zRotation, -1.0f, 1.0f);
+    xSpeed = std::copysign(xSpeed * xSpeed, xSpeed);
+    zRotation = std::copysign(zRotation * zRotation, zRotation);
+    float ray = std::hypot(xSpeed, zRotation);
+    float theta = std::atan2(zRotation, xSpeed) + M_PI_4;
+    float leftSpeed = ray * std::cos(theta) * std::sqrt(2.0f);
+    float rightSpeed = ray * std::sin(theta) * std::sqrt(2.0f);
+    float maxMagnitude = std::max(std::abs(leftSpeed), std::abs(rightSpeed));
+    if (maxMagnitude > 1.0f) {
+        leftSpeed /= maxMagnitude;
+        rightSpeed /= maxMagnitude;
+    }
+    return {leftSpeed, rightSpeed};
+}
+
+// Largest |d/dx| + |d/dz| of either wheel, by central differences
+float steepestSlope(const Kernel &kernel)
+{
+    float steepest = 0.0f;
+    for (int i = 0; i <= kSlopeGrid; ++i) {
+        for (int j = 0; j <= kSlopeGrid; ++j) {
+            float x = -1.0f + 2.0f * i / kSlopeGrid;
+            float z = -1.0f + 2.0f * j / kSlopeGrid;
+            float x0 = std::max(x - kSlopeStep, -1.0f);
+            float x1 = std::min(x + kSlopeStep, 1.0f);
+            float z0 = std::max(z - kSlopeStep, -1.0f);
+            float z1 = std::min(z + kSlopeStep, 1.0f);
+            WheelSpeeds dx0 = kernel(x0, z);
+            WheelSpeeds dx1 = kernel(x1, z);
+            WheelSpeeds dz0 = kernel(x, z0);
+            WheelSpeeds dz1 = kernel(x, z1);
+            float left = std::abs(dx1.left - dx0.left) / (x1 - x0) + std::abs(dz1.left - dz0.left) / (z1 - z0);
+            float right = std::abs(dx1.right - dx0.right) / (x1 - x0) + std::abs(dz1.right - dz0.right) / (z1 - z0);
+            steepest = std::max({steepest, left, right});
+        }
+    }
+    return steepest;
+}
+
+bool check(const char *name, const IKTable &table, const Kernel &kernel, size_t samples)
+{
+    size_t mismatches = 0;
+    for (int x = -IKTable::kSteps; x <= IKTable::kSteps; ++x) {
+        for (int z = -IKTable::kSteps; z <= IKTable::kSteps; ++z) {
+            float xSpeed = static_cast<float>(x) / IKTable::kSteps;
+            float zRotation = static_cast<float>(z) / IKTable::kSteps;
+            WheelSpeeds expected = kernel(xSpeed, zRotation);
+            WheelSpeeds actual = table.Lookup(xSpeed, zRotation);
+            if (IKTable::Quantize(actual.left) != IKTable::Quantize(expected.left) ||
+                IKTable::Quantize(actual.right) != IKTable::Quantize(expected.right)) {
+                if (mismatches < 4) {
+                    std::printf("  %s: x %+4d z %+4d table %+4d %+4d kernel %+4d %+4d\n", name, x, z,
+                        IKTable::Quantize(actual.left), IKTable::Quantize(actual.right),
+                        IKTable::Quantize(expected.left), IKTable::Quantize(expected.right));
+                }
+                ++mismatches;
+            }
+        }
+    }
+
+    // same seed for every table, so the runs are repeatable
+    std::mt19937 generator(1);
+    std::uniform_real_distribution<float> stick(-1.0f, 1.0f);
+    float worst = 0.0f;
+    for (size_t i = 0; i < samples; ++i) {
+        float xSpeed = stick(generator);
+        float zRotation = stick(generator);
+        WheelSpeeds expected = kernel(xSpeed, zRotation);
+        WheelSpeeds actual = table.Lookup(xSpeed, zRotation);
+        worst = std::max({worst, std::abs(actual.left - expected.left), std::abs(actual.right - expected.right)});
+    }
+    worst *= IKTable::kSteps;
+    float bound = 0.5f + 0.5f * steepestSlope(kernel);
+
+    bool passed = mismatches == 0 && worst <= bound;
+    std::printf("%-22s grid mismatches %5zu / %d   off-grid worst %.2f bound %.2f steps   %s\n",
+        name, mismatches, (2 * IKTable::kSteps + 1) * (2 * IKTable::kSteps + 1), worst, bound, passed ? "PASS" : "FAIL");
+    return passed;
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    size_t samples = 2000000;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--samples") == 0 && i + 1 < argc) {
+            samples = std::strtoull(argv[++i], nullptr, 10);
+        } else {
+            std::fprintf(stderr, "usage: %s [--samples N]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    std::printf("%zu bytes per table, %zu random sticks\n", sizeof(IKTable), samples);
+    bool passed = true;
+    passed &= check("arcade squared", kArcadeSquaredTable, [](float x, float z) {
+        return DifferentialDrive::ArcadeDriveIK(x, z, true);
+    }, samples);
+    passed &= check("curvature in place", kTurnInPlaceTable, [](float x, float z) {
+        return DifferentialDrive::CurvatureDriveIK(x, z, true);
+    }, samples);
+    passed &= check("reeltwo squared", kReelTwoSquaredTable, [](float x, float z) {
+        return DifferentialDrive::ReelTwoDriveIK(x, z, true);
+    }, samples);
+    passed &= check("reeltwo squared trig", kReelTwoSquaredTable, reelTwoTrig, samples);
+    passed &= check("reeltwo", kTurnInPlaceTable, [](float x, float z) {
+        return DifferentialDrive::ReelTwoDriveIK(x, z, false);
+    }, samples);
+    return passed ? 0 : 1;
+}
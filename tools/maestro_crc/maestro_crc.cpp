@@ -0,0 +1,181 @@
+/*
+    Host-side benchmark of the Maestro CRC-7.
+
+    Builds setMultiTarget frames the way ServoDispatch::animate() does and
+    times three ways of protecting them:
+      - no CRC, the cost of building the frame alone,
+      - the bitwise CRC over the finished frame, as the firmware used to,
+      - the table CRC carried along as each byte is queued (MaestroCRC).
+
+    Every frame's table CRC is checked against the bitwise one, and against
+    the example in the Pololu protocol documentation.  The CRC cost is
+    printed per frame, per byte, and next to the time the frame spends on
+    the wire at the Maestro's fastest baud rate.
+
+    usage: maestro_crc [--frames N] [--channels C]
+*/
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include "include/chopper/servo/MaestroCRC.h"
+
+namespace
+{
+
+constexpr uint8_t kDeviceNumber = 12;
+constexpr uint8_t kSetMultipleTargetsCommand = 0x1F;
+// the fastest rate the Maestro takes, 8N1
+constexpr double kBaudRate = 200000.0;
+
+enum class Method
+{
+    None,
+    Bitwise,
+    Table
+};
+
+struct Result
+{
+    double seconds;
+    uint32_t checksum;
+};
+
+// Appends a byte, updating the running CRC the way ServoDispatch::appendData() does
+template <Method method>
+inline void appendData(std::vector<uint8_t> &frame, uint8_t &crc, uint8_t data)
+{
+    frame.push_back(data);
+    if constexpr (method == Method::Table)
+    {
+        crc = MaestroCRC::update(crc, data);
+    }
+}
+
+template <Method method>
+void buildFrame(std::vector<uint8_t> &frame, const uint16_t *targets, uint8_t channels)
+{
+    uint8_t crc = 0;
+    frame.clear();
+    appendData<method>(frame, crc, 0xAA);
+    appendData<method>(frame, crc, kDeviceNumber);
+    appendData<method>(frame, crc, kSetMultipleTargetsCommand);
+    appendData<method>(frame, crc, channels);
+    appendData<method>(frame, crc, 0);
+    for (uint8_t i = 0; i < channels; ++i)
+    {
+        appendData<method>(frame, crc, targets[i] & 0x7F);
+        appendData<method>(frame, crc, (targets[i] >> 7) & 0x7F);
+    }
+    if constexpr (method == Method::Bitwise)
+    {
+        for (uint8_t byte : frame)
+        {
+            crc = MaestroCRC::updateBitwise(crc, byte);
+        }
+    }
+    if constexpr (method != Method::None)
+    {
+        frame.push_back(crc);
+    }
+}
+
+template <Method method>
+Result run(const std::vector<uint16_t> &targets, size_t frames, uint8_t channels)
+{
+    std::vector<uint8_t> frame;
+    frame.reserve(6 + 2 * channels);
+    uint32_t checksum = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < frames; ++i)
+    {
+        buildFrame<method>(frame, &targets[i * channels], channels);
+        checksum += frame.back();
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return {seconds, checksum};
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    size_t frames = 2000000;
+    unsigned channels = 24;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (std::strcmp(argv[i], "--frames") == 0 && i + 1 < argc)
+        {
+            frames = std::strtoul(argv[++i], nullptr, 10);
+        }
+        else if (std::strcmp(argv[i], "--channels") == 0 && i + 1 < argc)
+        {
+            channels = std::strtoul(argv[++i], nullptr, 10);
+        }
+        else
+        {
+            std::fprintf(stderr, "usage: %s [--frames N] [--channels C]\n", argv[0]);
+            return 2;
+        }
+    }
+    if (frames == 0 || channels == 0 || channels > 24)
+    {
+        std::fprintf(stderr, "frames must be positive and channels 1 to 24\n");
+        return 2;
+    }
+
+    // 0x83 0x01 carries the CRC 0x17, https://www.pololu.com/docs/0J40/5.d
+    const uint8_t example[] = {0x83, 0x01};
+    if (MaestroCRC::compute(example, sizeof(example)) != 0x17)
+    {
+        std::fprintf(stderr, "CRC of the protocol example is wrong\n");
+        return 1;
+    }
+
+    // targets in quarter microseconds, 750 to 2250 us
+    std::mt19937 random(1);
+    std::uniform_int_distribution<uint16_t> target(3000, 9000);
+    std::vector<uint16_t> targets(frames * channels);
+    for (uint16_t &value : targets)
+    {
+        value = target(random);
+    }
+
+    // the two CRCs must agree on every frame before either is timed
+    std::vector<uint8_t> bitwise;
+    std::vector<uint8_t> table;
+    for (size_t i = 0; i < frames; ++i)
+    {
+        buildFrame<Method::Bitwise>(bitwise, &targets[i * channels], channels);
+        buildFrame<Method::Table>(table, &targets[i * channels], channels);
+        if (bitwise != table)
+        {
+            std::fprintf(stderr, "frame %zu: table CRC %02x, bitwise CRC %02x\n", i, table.back(), bitwise.back());
+            return 1;
+        }
+    }
+
+    size_t frameBytes = table.size();
+    Result none = run<Method::None>(targets, frames, channels);
+    Result bitwiseResult = run<Method::Bitwise>(targets, frames, channels);
+    Result tableResult = run<Method::Table>(targets, frames, channels);
+
+    double wireNs = frameBytes * 10.0 / kBaudRate * 1e9;
+    std::printf("%zu setMultiTarget frames of %u channels, %zu bytes with CRC\n", frames, channels, frameBytes);
+    std::printf("CRC agrees on every frame (checksums %08x %08x)\n", bitwiseResult.checksum, tableResult.checksum);
+    std::printf("%-10s %10s %10s %12s\n", "method", "ns/frame", "CRC ns", "CRC ns/byte");
+    for (const auto &[name, result] : {std::pair{"none", none}, std::pair{"bitwise", bitwiseResult}, std::pair{"table", tableResult}})
+    {
+        double perFrame = result.seconds / frames * 1e9;
+        double crc = (result.seconds - none.seconds) / frames * 1e9;
+        std::printf("%-10s %10.1f %10.1f %12.2f\n", name, perFrame, crc, crc / frameBytes);
+    }
+    double tableCrc = (tableResult.seconds - none.seconds) / frames * 1e9;
+    std::printf("table CRC is %.4f%% of the frame's %.0f ns on the wire at %.0f baud\n",
+        100.0 * tableCrc / wireNs, wireNs, kBaudRate);
+    return 0;
+}
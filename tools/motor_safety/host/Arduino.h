@@ -0,0 +1,8 @@
+#pragma once
+
+/*
+    Host stand-in for the Arduino core, which chopper/Timer.h includes on
+    the way to MotorSafety.h.  The watchdog needs nothing from it beyond
+    the fixed width integers.
+*/
+#include <cstdint>
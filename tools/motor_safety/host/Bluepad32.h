@@ -0,0 +1,22 @@
+#pragma once
+
+/*
+    Host stand-in for Bluepad32, MotorSafety.cpp only prints through its
+    Console.  Defined in motor_safety.cpp.
+*/
+#include <cstdarg>
+#include <cstdio>
+
+class ConsoleT
+{
+public:
+    void printf(const char *format, ...)
+    {
+        va_list args;
+        va_start(args, format);
+        std::vprintf(format, args);
+        va_end(args);
+    }
+};
+
+extern ConsoleT Console;
@@ -0,0 +1,25 @@
+#pragma once
+
+/*
+    Host stand-in for the ESP-IDF pthread configuration, the watchdog thread
+    runs as a plain std::thread.
+*/
+#include <cstddef>
+
+typedef struct {
+    size_t stack_size;
+    size_t prio;
+    bool inherit_cfg;
+    const char *thread_name;
+    int pin_to_core;
+} esp_pthread_cfg_t;
+
+inline esp_pthread_cfg_t esp_pthread_get_default_config()
+{
+    return {};
+}
+
+inline int esp_pthread_set_cfg(const esp_pthread_cfg_t *)
+{
+    return 0;
+}
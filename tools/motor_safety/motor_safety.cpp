@@ -0,0 +1,270 @@
+/*
+    Host check of the motor safety ramp down and statistics.
+
+    Runs MotorSafety.cpp and its watchdog thread against the host clock
+    with a 200 ms expiration and a 100 ms stop ramp, and feeds a motor the
+    way the main loop does:
+      - every 10 ms, then a 400 ms gap, then every 10 ms again, which
+        must count one expiration, a 400 ms longest gap in the
+        200..500 ms bucket, and about 200 ms stopped (the gap less the
+        expiration),
+      - nothing until it has been stopped for 100 ms, a reset, then
+        nothing for another 100 ms, which must count only the 100 ms
+        stopped since the reset,
+      - nothing, which must ramp from full to 0 in one step every 
+        kRampStepMs, then hold it at 0 until the next Feed(),
+      - nothing, with a Feed() landing during the second ramp step, which
+        must put the full command back and end the ramp there.
+    A DifferentialDrive is then driven just slower than its expiration,
+    so every ramp step from the watchdog lands while the main loop is
+    setting the wheels, which must never run both at once.
+    Times are allowed kSlackMs for the host scheduler.
+
+    Exits non-zero if any check fails.
+
+    usage: motor_safety
+*/
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <Bluepad32.h>
+
+#include "chopper/MotorSafety.h"
+#include "chopper/drive/DifferentialDrive.h"
+
+ConsoleT Console;
+
+uint64_t Timer::GetFPGATimestamp()
+{
+    static const auto start = std::chrono::steady_clock::now();
+    return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+namespace
+{
+
+constexpr uint64_t kExpirationMs = 200;
+constexpr uint64_t kRampMs = 100;
+constexpr uint64_t kFeedPeriodMs = 10;
+constexpr uint64_t kGapMs = 400;
+constexpr uint64_t kSlackMs = 40;
+
+// the drive check sets the wheels for kWheelsMs, and again kDrivePeriodMs
+// after, just past the expiration so the next ramp step is under way
+constexpr uint64_t kDriveExpirationMs = 20;
+constexpr uint64_t kDrivePeriodMs = 22;
+constexpr uint64_t kWheelsMs = 8;
+constexpr int kDriveFrames = 40;
+
+// Records the scale of each ramp step instead of driving anything
+class Motor : public MotorSafety
+{
+public:
+    void StopMotor() override {}
+
+    void RampMotor(float scale) override
+    {
+        std::scoped_lock lock(_mutex);
+        _scales.push_back(scale);
+        if (_scales.size() == feedOnStep)
+        {
+            // fresh input from the main loop while the watchdog is stepping
+            Feed();
+        }
+    }
+
+    std::string GetDescription() const override
+    {
+        return "motor";
+    }
+
+    // Scales of the ramp steps since the last call
+    std::vector<float> takeScales()
+    {
+        std::scoped_lock lock(_mutex);
+        return std::exchange(_scales, {});
+    }
+
+    // Feed() from inside this ramp step, counted from takeScales(), 0 never
+    std::atomic<size_t> feedOnStep{0};
+
+private:
+    std::mutex _mutex;
+    std::vector<float> _scales;
+};
+
+void sleepFor(uint64_t milliseconds)
+{
+    std::this_thread::sleep_for(std::chrono::milliseconds(milliseconds));
+}
+
+void feedFor(Motor &motor, uint64_t milliseconds)
+{
+    for (uint64_t elapsed = 0; elapsed < milliseconds; elapsed += kFeedPeriodMs) {
+        motor.Feed();
+        sleepFor(kFeedPeriodMs);
+    }
+    motor.Feed();
+}
+
+bool expect(const char *name, uint64_t actual, uint64_t low, uint64_t high)
+{
+    bool passed = actual >= low && actual <= high;
+    std::printf("  %-16s %5llu   expected %llu..%llu   %s\n", name, static_cast<unsigned long long>(actual),
+        static_cast<unsigned long long>(low), static_cast<unsigned long long>(high), passed ? "PASS" : "FAIL");
+    return passed;
+}
+
+bool checkFeedGap(Motor &motor)
+{
+    std::printf("feed gap of %llu ms\n", static_cast<unsigned long long>(kGapMs));
+    motor.ResetStats();
+    feedFor(motor, 100);
+    sleepFor(kGapMs);
+    feedFor(motor, 100);
+
+    MotorSafety::Stats stats = motor.GetStats();
+    // the bucket holding the gap, see kFeedGapBounds
+    constexpr size_t gapBucket = 5;
+    bool passed = true;
+    passed &= expect("expirations", stats.expirations, 1, 1);
+    passed &= expect("max feed gap", stats.maxFeedGap, kGapMs, kGapMs + kSlackMs);
+    passed &= expect("gaps 200..500", stats.feedGaps[gapBucket], 1, 1);
+    passed &= expect("stopped time", stats.stoppedTime, kGapMs - kExpirationMs - kSlackMs,
+        kGapMs - kExpirationMs + kSlackMs);
+    passed &= expect("still stopped", motor.IsStopped(), 0, 0);
+    return passed;
+}
+
+bool checkResetWhileStopped(Motor &motor)
+{
+    std::printf("reset while stopped\n");
+    feedFor(motor, 50);
+    sleepFor(kExpirationMs + 100);
+    bool passed = expect("stopped at reset", motor.IsStopped(), 1, 1);
+    motor.ResetStats();
+    sleepFor(100);
+    motor.Feed();
+
+    MotorSafety::Stats stats = motor.GetStats();
+    passed &= expect("expirations", stats.expirations, 0, 0);
+    passed &= expect("stopped time", stats.stoppedTime, 100, 100 + kSlackMs);
+    return passed;
+}
+
+bool checkRamp(Motor &motor)
+{
+    std::printf("ramp down over %llu ms\n", static_cast<unsigned long long>(kRampMs));
+    feedFor(motor, 50);
+    motor.takeScales();
+    sleepFor(kExpirationMs + kRampMs + kSlackMs);
+
+    // full at the expiry, one step every kRampStepMs, then 0; a late wake
+    // may skip the last step before 0
+    std::vector<float> scales = motor.takeScales();
+    const size_t steps = kRampMs / MotorSafety::kRampStepMs + 1;
+    bool passed = expect("ramp steps", scales.size(), steps - 1, steps);
+    bool isFalling = !scales.empty() && scales.front() == 1.0f && scales.back() == 0.0f;
+    for (size_t i = 1; i < scales.size(); ++i)
+    {
+        isFalling &= scales[i] < scales[i - 1];
+    }
+    passed &= expect("full to 0", isFalling, 1, 1);
+
+    // latched at 0, and resent every expiration
+    sleepFor(2 * kExpirationMs + kSlackMs);
+    scales = motor.takeScales();
+    size_t moving = std::count_if(scales.begin(), scales.end(), [](float scale) { return scale != 0.0f; });
+    passed &= expect("resent stops", scales.size(), 2, 2);
+    passed &= expect("moving steps", moving, 0, 0);
+    passed &= expect("stopped", motor.IsStopped(), 1, 1);
+    motor.Feed();
+    passed &= expect("fed", motor.IsStopped(), 0, 0);
+    return passed;
+}
+
+bool checkFeedDuringRamp(Motor &motor)
+{
+    std::printf("feed during the ramp\n");
+    feedFor(motor, 50);
+    motor.takeScales();
+    motor.feedOnStep = 2;
+    // long enough for the whole ramp, short of the next expiry
+    sleepFor(kExpirationMs + kRampMs + kSlackMs);
+    motor.feedOnStep = 0;
+
+    std::vector<float> scales = motor.takeScales();
+    bool passed = expect("ramp steps", scales.size(), 3, 3);
+    passed &= expect("put back", scales.size() == 3 && scales[0] == 1.0f && scales[1] < 1.0f && scales[2] == 1.0f, 1, 1);
+    passed &= expect("stopped", motor.IsStopped(), 0, 0);
+    motor.Feed();
+    return passed;
+}
+
+bool checkDriveOutputs()
+{
+    std::printf("drive outputs against the ramp\n");
+    const std::thread::id mainThread = std::this_thread::get_id();
+    std::atomic<int> inside{0};
+    std::atomic<int> overlaps{0};
+    std::atomic<int> watchdogCalls{0};
+    DifferentialDrive drive([&](float, float) {
+        if (inside.fetch_add(1) != 0)
+        {
+            ++overlaps;
+        }
+        if (std::this_thread::get_id() != mainThread)
+        {
+            ++watchdogCalls;
+        }
+        sleepFor(kWheelsMs);
+        inside.fetch_sub(1);
+    });
+    drive.SetExpiration(kDriveExpirationMs);
+    drive.SetStopRamp(kRampMs);
+
+    for (int frame = 0; frame < kDriveFrames; ++frame)
+    {
+        drive.ArcadeDrive(0.5f, 0.25f);
+        sleepFor(kDrivePeriodMs);
+    }
+    // the firmware's drives are never destroyed, so let a step still under
+    // way finish before this one is
+    drive.SetSafetyEnabled(false);
+    sleepFor(kWheelsMs + kSlackMs);
+
+    bool passed = expect("watchdog steps", watchdogCalls, kDriveFrames / 2, 2 * kDriveFrames);
+    passed &= expect("overlaps", overlaps, 0, 0);
+    return passed;
+}
+
+} // namespace
+
+int main()
+{
+    Motor motor;
+    motor.SetExpiration(kExpirationMs);
+    motor.SetStopRamp(kRampMs);
+    motor.SetSafetyEnabled(true);
+
+    bool passed = true;
+    passed &= checkFeedGap(motor);
+    passed &= checkResetWhileStopped(motor);
+    passed &= checkRamp(motor);
+    passed &= checkFeedDuringRamp(motor);
+    MotorSafety::PrintAllStats();
+    // last, it stops the watchdog when the drive goes out of scope
+    passed &= checkDriveOutputs();
+    // the watchdog thread runs for the life of the firmware and is never
+    // joined, so leave without the static destructors
+    std::fflush(stdout);
+    std::_Exit(passed ? 0 : 1);
+}
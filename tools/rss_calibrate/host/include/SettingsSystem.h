@@ -0,0 +1,13 @@
+#ifndef __SETTINGS_SYSTEM_H__
+#define __SETTINGS_SYSTEM_H__
+
+/*
+    Host stand-in for main/include/SettingsSystem.h, which pulls in 
+    Bluepad32.  Only what the RSS headers need; keep the values in step 
+    with the firmware.
+*/
+#define RSS_MECHANISM_LIMIT_NORMAL_VECTOR      0.25f
+
+#define DEBUG_RSS_MACHINE_PRINTF(...)
+
+#endif
@@ -0,0 +1,367 @@
+/*
+    Host-side calibration sweep for the RSS neck.
+
+    Sweeps the joystick range over every height the neck can reach through
+    the firmware's own inverse kinematics (RSSKinematics::solveBatch), and
+    reports for each leg:
+      - the angle and PWM envelope of the poses that can be reached,
+      - where requests saturate (a leg past its limits, or out of reach),
+      - the PWM offset that best fits the measured MIN/MAX pulses, next to
+        the one RSSMechanism::calculateLegOffsets() derives today.
+
+    The offsets are written as a header to paste into SettingsUser.h.
+
+    usage: rss_calibrate [--samples N] [--limit L] [--range 180|270]
+                         [--pulses AMIN AMAX BMIN BMAX CMIN CMAX]
+                         [--out FILE]
+*/
+#include <algorithm>
+#include <array>
+#include <cfloat>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "include/SettingsSystem.h"
+#include "include/settings/ServoPWM.h"
+#include "include/chopper/dome/RSSMachine.h"
+
+namespace
+{
+
+constexpr const char *kLegNames[3] = {"A", "B", "C"};
+
+struct Options
+{
+    size_t samples = 4000000;
+    float limit = C110P_RSS_MECHANISM_LIMIT_NORMAL_VECTOR;
+    uint16_t actuationRange = C110P_RSS_MECHANISM_ACTUATION_RANGE;
+    std::array<uint16_t, 3> minPulse = {MAESTRO_BODY_NECK_A_MIN, MAESTRO_BODY_NECK_B_MIN, MAESTRO_BODY_NECK_C_MIN};
+    std::array<uint16_t, 3> maxPulse = {MAESTRO_BODY_NECK_A_MAX, MAESTRO_BODY_NECK_B_MAX, MAESTRO_BODY_NECK_C_MAX};
+    const char *out = nullptr;
+};
+
+// Exposes the geometry RSSMachine derives, which the firmware keeps protected
+class Geometry : public RSSMachine
+{
+public:
+    using RSSMachine::RSSMachine;
+
+    float minHeight() const { return _platformMinHeight; }
+    float maxHeight() const { return _platformMaxHeight; }
+    float minHeightAngle() const { return _platformMinHeightAngle; }
+    float maxHeightAngle() const { return _platformMaxHeightAngle; }
+};
+
+// Servo angle to pulse, as RSSMechanism maps it for the actuation range
+struct ServoMap
+{
+    float minPulse;
+    float maxPulse;
+    float range;
+
+    explicit ServoMap(uint16_t actuationRange) :
+        minPulse(actuationRange == 270 ? 500.0f : 750.0f),
+        maxPulse(actuationRange == 270 ? 2500.0f : 2250.0f),
+        range(actuationRange)
+    {
+    }
+
+    float toPWM(float angle) const
+    {
+        return minPulse + angle * (maxPulse - minPulse) / range;
+    }
+
+    // Arduino map() on whole degrees, like RSSMechanism::mapAngleToPWM()
+    long toPWMRounded(float angle) const
+    {
+        long x = static_cast<uint16_t>(std::lround(angle));
+        return x * (static_cast<long>(maxPulse) - static_cast<long>(minPulse)) / static_cast<long>(range) + static_cast<long>(minPulse);
+    }
+};
+
+/*
+    Mirrors RSSMechanism::calculateLegOffsets(), so the report shows 
+    exactly what the robot uses today.
+*/
+std::array<int, 3> firmwareOffsets(const Options &options, const Geometry &geometry, const ServoMap &servo)
+{
+    auto reference = [](const std::array<uint16_t, 3> &pulses) {
+        return static_cast<uint16_t>(std::round(
+            static_cast<float>(pulses[0]) + static_cast<float>(pulses[1]) + static_cast<float>(pulses[2])) / 3.0f);
+    };
+    const uint16_t referenceMin = reference(options.minPulse);
+    const uint16_t referenceMax = reference(options.maxPulse);
+    const uint16_t minHeightPWM = servo.toPWMRounded(geometry.minHeightAngle());
+    const uint16_t maxHeightPWM = servo.toPWMRounded(geometry.maxHeightAngle());
+    std::array<int, 3> offsets;
+    for (size_t i = 0; i < 3; ++i)
+    {
+        const uint16_t minPulse = options.minPulse[i];
+        const uint16_t maxPulse = options.maxPulse[i];
+        int offset = 0;
+        int legOffset = 0;
+        if (minPulse != 0 && maxPulse == 0)
+        {
+            offset = std::max(referenceMin, referenceMax) - std::max(minHeightPWM, maxHeightPWM);
+            legOffset = offset + (minPulse - referenceMin);
+        }
+        else if (minPulse == 0 || maxPulse != 0)
+        {
+            offset = std::min(referenceMin, referenceMax) - std::min(minHeightPWM, maxHeightPWM);
+            legOffset = offset + (maxPulse - referenceMax);
+        }
+        else
+        {
+            offset = (
+                std::max(referenceMin, referenceMax) - std::max(minHeightPWM, maxHeightPWM)
+            ) + (
+                std::min(referenceMin, referenceMax) - std::min(minHeightPWM, maxHeightPWM)
+            ) / 2;
+            legOffset = offset + ((minPulse - referenceMin) + (maxPulse - referenceMax)) / 2;
+        }
+        offsets[i] = static_cast<int16_t>(legOffset);
+    }
+    return offsets;
+}
+
+/*
+    Offset that lines the leg's theoretical pulses at the lowest and highest
+    platform up with its measured MIN/MAX pulses, in the least-squares sense.
+    The larger measured pulse goes with the larger theoretical one.
+*/
+std::array<int, 3> bestOffsets(const Options &options, const Geometry &geometry, const ServoMap &servo, std::array<float, 3> &spanError)
+{
+    const float a = servo.toPWM(geometry.minHeightAngle());
+    const float b = servo.toPWM(geometry.maxHeightAngle());
+    std::array<int, 3> offsets;
+    for (size_t i = 0; i < 3; ++i)
+    {
+        const float low = std::min(options.minPulse[i], options.maxPulse[i]);
+        const float high = std::max(options.minPulse[i], options.maxPulse[i]);
+        offsets[i] = static_cast<int>(std::lround(((high - std::max(a, b)) + (low - std::min(a, b))) / 2.0f));
+        spanError[i] = (high - low) - std::fabs(a - b);
+    }
+    return offsets;
+}
+
+struct LegStats
+{
+    float minAngle = FLT_MAX;
+    float maxAngle = -FLT_MAX;
+    size_t belowLimit = 0;
+    size_t aboveLimit = 0;
+};
+
+bool parse(int argc, char **argv, Options &options)
+{
+    for (int i = 1; i < argc; ++i)
+    {
+        auto next = [&](int count) {
+            if (i + count >= argc)
+            {
+                std::fprintf(stderr, "%s needs %d value(s)\n", argv[i], count);
+                std::exit(2);
+            }
+        };
+        if (std::strcmp(argv[i], "--samples") == 0)
+        {
+            next(1);
+            options.samples = std::strtoull(argv[++i], nullptr, 10);
+        }
+        else if (std::strcmp(argv[i], "--limit") == 0)
+        {
+            next(1);
+            options.limit = std::strtof(argv[++i], nullptr);
+        }
+        else if (std::strcmp(argv[i], "--range") == 0)
+        {
+            next(1);
+            options.actuationRange = static_cast<uint16_t>(std::atoi(argv[++i]));
+        }
+        else if (std::strcmp(argv[i], "--pulses") == 0)
+        {
+            next(6);
+            for (size_t leg = 0; leg < 3; ++leg)
+            {
+                options.minPulse[leg] = static_cast<uint16_t>(std::atoi(argv[++i]));
+                options.maxPulse[leg] = static_cast<uint16_t>(std::atoi(argv[++i]));
+            }
+        }
+        else if (std::strcmp(argv[i], "--out") == 0)
+        {
+            next(1);
+            options.out = argv[++i];
+        }
+        else
+        {
+            std::fprintf(stderr,
+                "usage: %s [--samples N] [--limit L] [--range 180|270]\n"
+                "          [--pulses AMIN AMAX BMIN BMAX CMIN CMAX] [--out FILE]\n", argv[0]);
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    Options options;
+    if (!parse(argc, argv, options))
+    {
+        return 2;
+    }
+
+    Geometry geometry(
+        C110P_RSS_MECHANISM_BASE_ALTITUDE,
+        C110P_RSS_MECHANISM_END_EFFECTOR_ALTITUDE,
+        C110P_RSS_MECHANISM_BOTTOM_LINK_LENGTH,
+        C110P_RSS_MECHANISM_TOP_LINK_LENGTH,
+        C110P_RSS_MECHANISM_MIN_HEIGHT,
+        options.limit,
+        C110P_RSS_MECHANISM_BEND_OUT);
+    RSSKinematics kinematics(
+        C110P_RSS_MECHANISM_BASE_ALTITUDE * std::sqrt(3.0f) / 3.0f,
+        C110P_RSS_MECHANISM_END_EFFECTOR_ALTITUDE * std::sqrt(3.0f) / 3.0f,
+        C110P_RSS_MECHANISM_BOTTOM_LINK_LENGTH,
+        C110P_RSS_MECHANISM_TOP_LINK_LENGTH,
+        C110P_RSS_MECHANISM_BEND_OUT);
+    ServoMap servo(options.actuationRange);
+
+    const float lowAngle = std::min(geometry.minHeightAngle(), geometry.maxHeightAngle());
+    const float highAngle = std::max(geometry.minHeightAngle(), geometry.maxHeightAngle());
+
+    // height bands x a square grid of joystick tilt in each
+    const size_t bands = 64;
+    const size_t grid = std::max<size_t>(2, static_cast<size_t>(std::sqrt(static_cast<double>(options.samples) / bands)));
+    const size_t perBand = grid * grid;
+    const size_t total = perBand * bands;
+
+    std::vector<float> nx(perBand), ny(perBand), nz(perBand), hz(perBand);
+    std::vector<float> angleA(perBand), angleB(perBand), angleC(perBand);
+    std::vector<uint8_t> isValid(perBand);
+    std::array<float *, 3> angles = {angleA.data(), angleB.data(), angleC.data()};
+
+    std::array<LegStats, 3> legs;
+    std::vector<size_t> saturatedPerBand(bands, 0);
+    size_t unreachable = 0;
+    double solveSeconds = 0.0;
+
+    for (size_t band = 0; band < bands; ++band)
+    {
+        const float height = geometry.minHeight() + (geometry.maxHeight() - geometry.minHeight()) * band / (bands - 1);
+        for (size_t iy = 0; iy < grid; ++iy)
+        {
+            for (size_t ix = 0; ix < grid; ++ix)
+            {
+                const size_t i = iy * grid + ix;
+                const float jx = -options.limit + 2.0f * options.limit * ix / (grid - 1);
+                const float jy = -options.limit + 2.0f * options.limit * iy / (grid - 1);
+                // the same normalizing and limiting the firmware does
+                std::tie(nx[i], ny[i], nz[i]) = geometry.unitNormalVector(jx, jy);
+                hz[i] = height;
+            }
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        kinematics.solveBatch(perBand, nx.data(), ny.data(), nz.data(), hz.data(),
+            angleA.data(), angleB.data(), angleC.data(), isValid.data());
+        solveSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        for (size_t i = 0; i < perBand; ++i)
+        {
+            bool saturated = !isValid[i];
+            unreachable += !isValid[i];
+            for (size_t leg = 0; leg < 3; ++leg)
+            {
+                const float angle = angles[leg][i];
+                if (angle < lowAngle)
+                {
+                    ++legs[leg].belowLimit;
+                    saturated = true;
+                }
+                else if (angle > highAngle)
+                {
+                    ++legs[leg].aboveLimit;
+                    saturated = true;
+                }
+            }
+            if (saturated)
+            {
+                ++saturatedPerBand[band];
+                continue;
+            }
+            for (size_t leg = 0; leg < 3; ++leg)
+            {
+                legs[leg].minAngle = std::min(legs[leg].minAngle, angles[leg][i]);
+                legs[leg].maxAngle = std::max(legs[leg].maxAngle, angles[leg][i]);
+            }
+        }
+    }
+
+    std::array<int, 3> current = firmwareOffsets(options, geometry, servo);
+    std::array<float, 3> spanError;
+    std::array<int, 3> best = bestOffsets(options, geometry, servo, spanError);
+
+    std::printf("geometry: height %.2f..%.2f, leg limits %.2f..%.2f deg, tilt limit %.3f, %u deg servos\n",
+        geometry.minHeight(), geometry.maxHeight(), lowAngle, highAngle, options.limit, options.actuationRange);
+    std::printf("swept %zu poses (%zu bands x %zux%zu) in %.3f s, %.1f M poses/s\n",
+        total, bands, grid, grid, solveSeconds, total / solveSeconds / 1e6);
+    std::printf("unreachable: %.2f%%\n\n", 100.0 * unreachable / total);
+
+    std::printf("leg  reachable angle     below  above   MIN   MAX  span err  offset now  best  PWM envelope (best)\n");
+    for (size_t leg = 0; leg < 3; ++leg)
+    {
+        const LegStats &stats = legs[leg];
+        const float low = servo.toPWM(stats.minAngle) + best[leg];
+        const float high = servo.toPWM(stats.maxAngle) + best[leg];
+        std::printf(" %s   %6.2f..%6.2f   %5.1f%% %5.1f%%  %4u  %4u  %+8.1f  %10d  %4d  %4.0f..%4.0f\n",
+            kLegNames[leg], stats.minAngle, stats.maxAngle,
+            100.0 * stats.belowLimit / total, 100.0 * stats.aboveLimit / total,
+            options.minPulse[leg], options.maxPulse[leg], spanError[leg],
+            current[leg], best[leg], low, high);
+    }
+
+    std::printf("\nsaturated requests by height:\n");
+    for (size_t band = 0; band < bands; band += bands / 16)
+    {
+        const float height = geometry.minHeight() + (geometry.maxHeight() - geometry.minHeight()) * band / (bands - 1);
+        const float percent = 100.0f * saturatedPerBand[band] / perBand;
+        std::printf("  %6.2f  %5.1f%%  %s\n", height, percent, std::string(static_cast<size_t>(percent / 2.5f), '#').c_str());
+    }
+
+    FILE *out = options.out ? std::fopen(options.out, "w") : stdout;
+    if (out == nullptr)
+    {
+        std::perror(options.out);
+        return 1;
+    }
+    if (out == stdout)
+    {
+        std::printf("\n");
+    }
+    std::fprintf(out,
+        "// Generated by tools/rss_calibrate for MIN/MAX pulses A %u/%u, B %u/%u, C %u/%u\n"
+        "// Reachable PWM: A %.0f..%.0f, B %.0f..%.0f, C %.0f..%.0f\n",
+        options.minPulse[0], options.maxPulse[0], options.minPulse[1], options.maxPulse[1],
+        options.minPulse[2], options.maxPulse[2],
+        servo.toPWM(legs[0].minAngle) + best[0], servo.toPWM(legs[0].maxAngle) + best[0],
+        servo.toPWM(legs[1].minAngle) + best[1], servo.toPWM(legs[1].maxAngle) + best[1],
+        servo.toPWM(legs[2].minAngle) + best[2], servo.toPWM(legs[2].maxAngle) + best[2]);
+    for (size_t leg = 0; leg < 3; ++leg)
+    {
+        std::fprintf(out, "#define C110P_RSS_MECHANISM_LEG_OFFSET_PWM_%s   %d\n", kLegNames[leg], best[leg]);
+    }
+    if (out != stdout)
+    {
+        std::fclose(out);
+        std::printf("\nwrote %s\n", options.out);
+    }
+    return 0;
+}
@@ -0,0 +1,353 @@
+/*
+    Host check and benchmark for the RSS neck inverse kinematics.
+
+    - Golden test: RSSMachine::solveLegAngles(), which runs the single
+      precision RSSKinematics kernel, against the IK it replaced (kept
+      below as baselineLegAngles(), std::pow and double std::sqrt(3) as
+      they were).  Sweeps every height and a tilt range wider than the
+      firmware limit, so unreachable poses are covered too, and fails if
+      any leg differs by a Maestro step (0.25 us) or more.  Away from a
+      fully stretched or folded leg the two agree to about 0.001 deg; at
+      full extension acos() magnifies single precision rounding, so the
+      count of poses past 0.001 deg is reported as well.
+    - Benchmark: time per pose for the baseline, RSSKinematics::solve()
+      and RSSKinematics::solveBatch().
+    - Leg table: the worst interpolation error of RSSLegTable on a dense
+      grid inside every cell, next to the cell centre estimate the table
+      logs on the robot.
+
+    Exits non-zero when the golden test fails.
+
+    usage: rss_kinematics [--iterations N]
+*/
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <tuple>
+#include <vector>
+
+#include "include/SettingsSystem.h"
+#include "include/settings/ServoPWM.h"
+#include "include/chopper/dome/RSSMachine.h"
+#include "include/chopper/dome/RSSLegTable.h"
+
+namespace
+{
+
+constexpr const char *kLegNames[3] = {"A", "B", "C"};
+// μs, the Maestro's pulse resolution
+constexpr float kTolerancePWM = 0.25f;
+// degrees, what a well conditioned pose is expected to match to
+constexpr float kCloseAngle = 0.001f;
+// joystick tilt swept by the golden test, beyond the firmware limit
+constexpr float kSweepLimit = 0.4f;
+
+// Exposes what RSSMachine keeps protected
+class Geometry : public RSSMachine
+{
+public:
+    using RSSMachine::RSSMachine;
+    using RSSMachine::solveLegAngles;
+
+    float minHeight() const { return _platformMinHeight; }
+    float maxHeight() const { return _platformMaxHeight; }
+};
+
+/*
+    RSSMachine::solveLegAngles() before the RSSKinematics kernel, including
+    the normalizing and limiting of the tilt.  Kept as it was so it stays a
+    fixed reference.
+*/
+std::array<float, 3> baselineLegAngles(float d, float e, float f, float g, bool bendOut,
+    float limit, float minHeight, float maxHeight, float nx, float ny, float hz)
+{
+    const float rad2deg = 180.0f / M_PI;
+    float nmag = std::sqrt(std::pow(nx, 2.0f) + std::pow(ny, 2.0f) + 1.0f);
+    nx = std::clamp(nx / nmag, -limit, limit);
+    ny = std::clamp(ny / nmag, -limit, limit);
+    float nz = 1.0f / nmag;
+    hz = std::clamp(hz, minHeight, maxHeight);
+
+    float x = 0.0f;
+    float y = 0.0f;
+    float z = 0.0f;
+    float mag = 0.0f;
+    float theta1 = 0.0f;
+    float theta2 = 0.0f;
+    std::array<float, 3> leg_angles({0.0f, 0.0f, 0.0f});
+    for (int i = 0; i < 3; ++i)
+    {
+        if (i == 0)
+        {
+            x = 0.0f;
+            y = d + (e / 2) * (
+                1 - (
+                    std::pow(nx, 2) + 3 * std::pow(nz, 2) + 3 * nz
+                ) / (
+                    nz + 1 - std::pow(nx, 2)
+                ) + (
+                    std::pow(nx, 4) - 3 * std::pow(nx, 2) * std::pow(ny, 2)
+                ) / (
+                    (nz + 1) * (nz + 1 - std::pow(nx, 2))
+                )
+            );
+            z = hz + e * ny;
+            mag = std::sqrt(std::pow(y, 2) + std::pow(z, 2));
+            theta1 = std::acos(std::clamp(y / mag, -1.0f, 1.0f));
+            theta2 = std::acos(std::clamp<float>(
+                (std::pow(mag, 2) + std::pow(f, 2) - std::pow(g, 2)) / (2 * mag * f), -1.0f, 1.0f)
+            );
+        }
+        else if (i == 1)
+        {
+            x = (std::sqrt(3) / 2) * (
+                e * (
+                    1 - (std::pow(nx, 2) + std::sqrt(3) * nx * ny) / (nz + 1)
+                ) - d
+            );
+            y = x / std::sqrt(3);
+            z = hz - (e / 2) * (std::sqrt(3) * nx + ny);
+            mag = std::sqrt(std::pow(x, 2) + std::pow(y, 2) + std::pow(z, 2));
+            theta1 = std::acos(std::clamp<float>(
+                (std::sqrt(3) * x + y) / (-2 * mag), -1.0f, 1.0f)
+            );
+            theta2 = std::acos(std::clamp<float>(
+                (std::pow(mag, 2) + std::pow(f, 2) - std::pow(g, 2)) / (2 * mag * f), -1.0f, 1.0f)
+            );
+        }
+        else
+        {
+            x = (std::sqrt(3) / 2) * (
+                d - e * (
+                    1 - (std::pow(nx, 2) - std::sqrt(3) * nx * ny) / (nz + 1)
+                )
+            );
+            y = -x / std::sqrt(3);
+            z = hz + (e / 2) * (std::sqrt(3) * nx - ny);
+            mag = std::sqrt(std::pow(x, 2) + std::pow(y, 2) + std::pow(z, 2));
+            theta1 = std::acos(std::clamp<float>(
+                (std::sqrt(3) * x - y) / (2 * mag), -1.0f, 1.0f)
+            );
+            theta2 = std::acos(std::clamp<float>(
+                (std::pow(mag, 2) + std::pow(f, 2) - std::pow(g, 2)) / (2 * mag * f), -1.0f, 1.0f)
+            );
+        }
+        leg_angles[i] = (bendOut ? theta1 + theta2 : theta1 - theta2) * rad2deg;
+    }
+    return leg_angles;
+}
+
+struct Pose
+{
+    float nx;
+    float ny;
+    float hz;
+};
+
+// Height bands x a square grid of joystick tilt, out to +/- limit
+std::vector<Pose> sweep(float minHeight, float maxHeight, float limit, size_t bands, size_t grid)
+{
+    std::vector<Pose> poses;
+    poses.reserve(bands * grid * grid);
+    for (size_t band = 0; band < bands; ++band)
+    {
+        const float hz = minHeight + (maxHeight - minHeight) * band / (bands - 1);
+        for (size_t iy = 0; iy < grid; ++iy)
+        {
+            for (size_t ix = 0; ix < grid; ++ix)
+            {
+                poses.push_back({
+                    -limit + 2.0f * limit * ix / (grid - 1),
+                    -limit + 2.0f * limit * iy / (grid - 1),
+                    hz});
+            }
+        }
+    }
+    return poses;
+}
+
+template <typename Function>
+double nanosecondsPerPose(size_t count, size_t iterations, Function &&function)
+{
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < iterations; ++i)
+    {
+        function();
+    }
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / (count * iterations);
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    size_t iterations = 20;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (std::strcmp(argv[i], "--iterations") == 0 && i + 1 < argc)
+        {
+            iterations = std::strtoull(argv[++i], nullptr, 10);
+        }
+        else
+        {
+            std::fprintf(stderr, "usage: %s [--iterations N]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    const float d = C110P_RSS_MECHANISM_BASE_ALTITUDE * std::sqrt(3.0f) / 3.0f;
+    const float e = C110P_RSS_MECHANISM_END_EFFECTOR_ALTITUDE * std::sqrt(3.0f) / 3.0f;
+    const float f = C110P_RSS_MECHANISM_BOTTOM_LINK_LENGTH;
+    const float g = C110P_RSS_MECHANISM_TOP_LINK_LENGTH;
+    const bool bendOut = C110P_RSS_MECHANISM_BEND_OUT;
+
+    // a wide limit for the golden test, the firmware one for the leg table
+    Geometry wide(
+        C110P_RSS_MECHANISM_BASE_ALTITUDE,
+        C110P_RSS_MECHANISM_END_EFFECTOR_ALTITUDE,
+        f, g,
+        C110P_RSS_MECHANISM_MIN_HEIGHT,
+        kSweepLimit,
+        bendOut);
+    Geometry firmware(
+        C110P_RSS_MECHANISM_BASE_ALTITUDE,
+        C110P_RSS_MECHANISM_END_EFFECTOR_ALTITUDE,
+        f, g,
+        C110P_RSS_MECHANISM_MIN_HEIGHT,
+        C110P_RSS_MECHANISM_LIMIT_NORMAL_VECTOR,
+        bendOut);
+    RSSKinematics kinematics(d, e, f, g, bendOut);
+
+    const float minPulse = C110P_RSS_MECHANISM_ACTUATION_RANGE == 270 ? 500.0f : 750.0f;
+    const float maxPulse = C110P_RSS_MECHANISM_ACTUATION_RANGE == 270 ? 2500.0f : 2250.0f;
+    const float degreesPerMicrosecond = C110P_RSS_MECHANISM_ACTUATION_RANGE / (maxPulse - minPulse);
+
+    // golden test
+    const float tolerance = kTolerancePWM * degreesPerMicrosecond;
+    const std::vector<Pose> poses = sweep(wide.minHeight(), wide.maxHeight(), kSweepLimit, 61, 41);
+    std::array<float, 3> worst = {0.0f, 0.0f, 0.0f};
+    std::array<Pose, 3> worstPose = {};
+    size_t failures = 0;
+    size_t notClose = 0;
+    for (const Pose &pose : poses)
+    {
+        const std::array<float, 3> expected = baselineLegAngles(d, e, f, g, bendOut,
+            kSweepLimit, wide.minHeight(), wide.maxHeight(), pose.nx, pose.ny, pose.hz);
+        const std::array<float, 3> actual = wide.solveLegAngles(pose.nx, pose.ny, pose.hz);
+        bool failed = false;
+        bool close = true;
+        for (size_t leg = 0; leg < 3; ++leg)
+        {
+            const float error = std::fabs(actual[leg] - expected[leg]);
+            if (error > worst[leg])
+            {
+                worst[leg] = error;
+                worstPose[leg] = pose;
+            }
+            failed |= !(error < tolerance);
+            close &= error <= kCloseAngle;
+        }
+        failures += failed;
+        notClose += !close;
+    }
+    std::printf("golden: %zu poses, height %.2f..%.2f, tilt +/-%.2f, tolerance %.4f deg (%.2f us)\n",
+        poses.size(), wide.minHeight(), wide.maxHeight(), kSweepLimit, tolerance, kTolerancePWM);
+    for (size_t leg = 0; leg < 3; ++leg)
+    {
+        std::printf("  %s  max diff %.6f deg (%.3f us) at nx %+.3f ny %+.3f hz %.2f\n",
+            kLegNames[leg], worst[leg], worst[leg] / degreesPerMicrosecond,
+            worstPose[leg].nx, worstPose[leg].ny, worstPose[leg].hz);
+    }
+    std::printf("  poses past %.3f deg: %zu\n", kCloseAngle, notClose);
+    std::printf("  %s\n\n", failures == 0 ? "PASS" : "FAIL");
+
+    // benchmark
+    const size_t count = poses.size();
+    std::vector<float> nx(count), ny(count), nz(count), hz(count);
+    std::vector<float> angleA(count), angleB(count), angleC(count);
+    std::vector<uint8_t> isValid(count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        std::tie(nx[i], ny[i], nz[i]) = wide.unitNormalVector(poses[i].nx, poses[i].ny);
+        hz[i] = poses[i].hz;
+    }
+    volatile float sink = 0.0f;
+    const double baselineNs = nanosecondsPerPose(count, iterations, [&] {
+        for (const Pose &pose : poses)
+        {
+            sink = sink + baselineLegAngles(d, e, f, g, bendOut,
+                kSweepLimit, wide.minHeight(), wide.maxHeight(), pose.nx, pose.ny, pose.hz)[0];
+        }
+    });
+    const double solveNs = nanosecondsPerPose(count, iterations, [&] {
+        for (size_t i = 0; i < count; ++i)
+        {
+            sink = sink + kinematics.solve(nx[i], ny[i], nz[i], hz[i]).angles[0];
+        }
+    });
+    const double batchNs = nanosecondsPerPose(count, iterations, [&] {
+        kinematics.solveBatch(count, nx.data(), ny.data(), nz.data(), hz.data(),
+            angleA.data(), angleB.data(), angleC.data(), isValid.data());
+        sink = sink + angleA[count / 2];
+    });
+    std::printf("benchmark: %zu poses x %zu\n", count, iterations);
+    std::printf("  baseline     %7.1f ns/pose\n", baselineNs);
+    std::printf("  solve        %7.1f ns/pose  (%.2fx)\n", solveNs, baselineNs / solveNs);
+    std::printf("  solveBatch   %7.1f ns/pose  (%.2fx)\n\n", batchNs, baselineNs / batchNs);
+
+    // leg table, built the way RSSMechanism::buildLegTable() does less the leg offsets
+    auto solvePWM = [&](float tx, float ty, float th) {
+        std::array<float, 3> legs = firmware.solveLegAngles(tx, ty, th);
+        for (float &angle : legs)
+        {
+            angle = minPulse + angle * (maxPulse - minPulse) / C110P_RSS_MECHANISM_ACTUATION_RANGE;
+        }
+        return legs;
+    };
+    const float range = C110P_RSS_MECHANISM_LIMIT_NORMAL_VECTOR * static_cast<float>(M_SQRT2);
+    static RSSLegTable table;
+    table.build(solvePWM, range, firmware.minHeight(), firmware.maxHeight());
+
+    // every cell split into kSteps along each axis, edges included
+    constexpr size_t kSteps = 16;
+    const size_t gridPoints = (RSSLegTable::kGridSize - 1) * kSteps + 1;
+    const size_t heightPoints = (RSSLegTable::kHeightBands - 1) * kSteps + 1;
+    float tableWorst = 0.0f;
+    Pose tableWorstPose = {};
+    size_t tableWorstLeg = 0;
+    for (size_t ih = 0; ih < heightPoints; ++ih)
+    {
+        const float th = firmware.minHeight() + (firmware.maxHeight() - firmware.minHeight()) * ih / (heightPoints - 1);
+        for (size_t iy = 0; iy < gridPoints; ++iy)
+        {
+            const float ty = -range + 2.0f * range * iy / (gridPoints - 1);
+            for (size_t ix = 0; ix < gridPoints; ++ix)
+            {
+                const float tx = -range + 2.0f * range * ix / (gridPoints - 1);
+                const std::array<float, 3> exact = solvePWM(tx, ty, th);
+                const std::array<float, 3> approx = table.lookup(tx, ty, th);
+                for (size_t leg = 0; leg < 3; ++leg)
+                {
+                    const float error = std::fabs(exact[leg] - approx[leg]);
+                    if (error > tableWorst)
+                    {
+                        tableWorst = error;
+                        tableWorstPose = {tx, ty, th};
+                        tableWorstLeg = leg;
+                    }
+                }
+            }
+        }
+    }
+    std::printf("leg table: %ux%u grid, %u bands, %zu samples\n",
+        RSSLegTable::kGridSize, RSSLegTable::kGridSize, RSSLegTable::kHeightBands, gridPoints * gridPoints * heightPoints);
+    std::printf("  cell centre estimate  %6.2f us\n", table.maxError());
+    std::printf("  dense worst case      %6.2f us  leg %s at nx %+.3f ny %+.3f hz %.2f\n",
+        tableWorst, kLegNames[tableWorstLeg], tableWorstPose.nx, tableWorstPose.ny, tableWorstPose.hz);
+
+    return failures == 0 ? 0 : 1;
+}